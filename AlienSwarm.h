@@ -0,0 +1,348 @@
+#pragma once
+#include "TextInvaders.h"
+
+// What can be done to a swarm without knowing about the rest of the game, for a BasicAlienSwarm of any layout.
+// The game plays with the classic AlienSwarm, and with its layout known at compile time the loops over rows and columns
+// have fixed trip counts and the positions are table lookups, but a bigger swarm can be instantiated from the same code.
+
+template<class LAYOUT>
+int AlienX(const BasicAlienSwarm<LAYOUT>& aliens, int col)
+{
+	return aliens.position.x + LAYOUT::columnOffset[col];
+}
+
+template<class LAYOUT>
+int AlienY(const BasicAlienSwarm<LAYOUT>& aliens, int row)
+{
+	return aliens.position.y + LAYOUT::rowOffset[row];
+}
+
+// the sprite the aliens in the row are drawn and hit tested with
+template<class LAYOUT>
+const AlienSprite& AlienSpriteOfRow(int row)
+{
+	static_assert(int(LAYOUT::SPRITE_WIDTH) == ALIEN_SPRITE_WIDTH && int(LAYOUT::SPRITE_HEIGHT) == ALIEN_SPRITE_HEIGHT, "the layout's aliens have to be the size of the alien sprites");
+
+	return *ALIEN_SPRITES[LAYOUT::rowType[row]];
+}
+
+// every alien alive, no bombs, where the swarm is and how it moves is up to the caller
+template<class LAYOUT>
+void InitSwarm(BasicAlienSwarm<LAYOUT>& aliens)
+{
+	for (int row = 0; row < LAYOUT::NUM_ROWS; row++)
+	{
+		aliens.aliveInRow[row] = BitRange(0, LAYOUT::NUM_COLS);
+		aliens.explodingInRow[row] = 0;
+	}
+
+	for (int col = 0; col < LAYOUT::NUM_COLS; col++)
+	{
+		aliens.aliveInColumn[col] = BitRange(0, LAYOUT::NUM_ROWS);
+		aliens.explodingInColumn[col] = 0;
+		aliens.lowestAlienInColumn[col] = LAYOUT::NUM_ROWS - 1;
+		aliens.shooterColumns[col] = col;
+		aliens.shooterColumnIndex[col] = col;
+	}
+
+	aliens.occupiedColumns = BitRange(0, LAYOUT::NUM_COLS);
+	aliens.occupiedRows = BitRange(0, LAYOUT::NUM_ROWS);
+	aliens.numberOfShooterColumns = LAYOUT::NUM_COLS;
+	aliens.numAliensLeft = LAYOUT::NUM_ALIENS;
+
+	InitProjectiles(aliens.bombs);
+}
+
+template<class LAYOUT>
+AlienState GetAlienState(const BasicAlienSwarm<LAYOUT>& aliens, int row, int col)
+{
+	Bitmask bit = Bitmask(1) << col;
+
+	if (aliens.aliveInRow[row] & bit)
+	{
+		return AS_ALIVE;
+	}
+	else if (aliens.explodingInRow[row] & bit)
+	{
+		return AS_EXPLODING;
+	}
+
+	return AS_DEAD;
+}
+
+template<class LAYOUT>
+void SetAlienState(BasicAlienSwarm<LAYOUT>& aliens, int row, int col, AlienState state)
+{
+	Bitmask colBit = Bitmask(1) << col;
+	Bitmask rowBit = Bitmask(1) << row;
+
+	aliens.aliveInRow[row] &= ~colBit;
+	aliens.explodingInRow[row] &= ~colBit;
+	aliens.aliveInColumn[col] &= ~rowBit;
+	aliens.explodingInColumn[col] &= ~rowBit;
+
+	if (state == AS_ALIVE)
+	{
+		aliens.aliveInRow[row] |= colBit;
+		aliens.aliveInColumn[col] |= rowBit;
+	}
+	else if (state == AS_EXPLODING)
+	{
+		aliens.explodingInRow[row] |= colBit;
+		aliens.explodingInColumn[col] |= rowBit;
+	}
+
+	// the column and row only stay occupied if something else in them is still alive or exploding
+	aliens.occupiedColumns &= ~colBit;
+	aliens.occupiedColumns |= Bitmask((aliens.aliveInColumn[col] | aliens.explodingInColumn[col]) != 0) << col;
+	aliens.occupiedRows &= ~rowBit;
+	aliens.occupiedRows |= Bitmask((aliens.aliveInRow[row] | aliens.explodingInRow[row]) != 0) << row;
+}
+
+// called when the lowest living alien in the column has just been hit, exploding aliens can't shoot
+// so nothing needs to happen here when explosions expire
+template<class LAYOUT>
+void UpdateLowestAlien(BasicAlienSwarm<LAYOUT>& aliens, int col)
+{
+	if (aliens.aliveInColumn[col] != 0)
+	{
+		aliens.lowestAlienInColumn[col] = HighestSetBit(aliens.aliveInColumn[col]);
+	}
+	else if (aliens.shooterColumnIndex[col] != NOT_IN_PLAY)
+	{
+		// swap the last shooter column into this column's place
+		int index = aliens.shooterColumnIndex[col];
+		int lastColumn = aliens.shooterColumns[aliens.numberOfShooterColumns - 1];
+
+		aliens.shooterColumns[index] = lastColumn;
+		aliens.shooterColumnIndex[lastColumn] = index;
+		aliens.shooterColumnIndex[col] = NOT_IN_PLAY;
+		aliens.lowestAlienInColumn[col] = NOT_IN_PLAY;
+		aliens.numberOfShooterColumns--;
+	}
+}
+
+// every exploding alien is now dead
+template<class LAYOUT>
+void ExpireExplosions(BasicAlienSwarm<LAYOUT>& aliens)
+{
+	Bitmask occupiedColumns = 0;
+	Bitmask occupiedRows = 0;
+
+	for (int row = 0; row < LAYOUT::NUM_ROWS; row++)
+	{
+		aliens.explodingInRow[row] = 0;
+		occupiedColumns |= aliens.aliveInRow[row];
+	}
+
+	for (int col = 0; col < LAYOUT::NUM_COLS; col++)
+	{
+		aliens.explodingInColumn[col] = 0;
+		occupiedRows |= aliens.aliveInColumn[col];
+	}
+
+	aliens.occupiedColumns = occupiedColumns;
+	aliens.occupiedRows = occupiedRows;
+}
+
+template<class LAYOUT>
+void FindEmptyRowsAndColumns(const BasicAlienSwarm<LAYOUT>& aliens, int& emptyColsLeft, int& emptyColsRight, int& emptyRowsBottom)
+{
+	if (aliens.occupiedColumns == 0)
+	{
+		emptyColsLeft = LAYOUT::NUM_COLS;
+		emptyColsRight = LAYOUT::NUM_COLS;
+		emptyRowsBottom = LAYOUT::NUM_ROWS;
+		return;
+	}
+
+	emptyColsLeft = LowestSetBit(aliens.occupiedColumns);
+	emptyColsRight = LAYOUT::NUM_COLS - 1 - HighestSetBit(aliens.occupiedColumns);
+	emptyRowsBottom = LAYOUT::NUM_ROWS - 1 - HighestSetBit(aliens.occupiedRows);
+}
+
+template<class LAYOUT>
+bool IsCollision(const Player& player, const BasicAlienSwarm<LAYOUT>& aliens, Position& alienCollidePositionInArray)
+{
+	alienCollidePositionInArray.x = NOT_IN_PLAY;
+	alienCollidePositionInArray.y = NOT_IN_PLAY;
+
+	int emptyColsLeft = 0;
+	int emptyColsRight = 0;
+	int emptyRowsBottom = 0;
+
+	FindEmptyRowsAndColumns(aliens, emptyColsLeft, emptyColsRight, emptyRowsBottom);
+
+	int dx = player.missile.x - aliens.position.x;
+	int dy = player.missile.y - aliens.position.y;
+
+	// broad phase: is the missile anywhere near what's left of the swarm
+	if (dx < emptyColsLeft * LAYOUT::CELL_WIDTH || dx >= (LAYOUT::NUM_COLS - emptyColsRight) * LAYOUT::CELL_WIDTH ||
+		dy < 0 || dy >= (LAYOUT::NUM_ROWS - emptyRowsBottom) * LAYOUT::CELL_HEIGHT)
+	{
+		return false;
+	}
+
+	// the missile can only be in one cell, it hits if that alien is alive and the missile is on one of its opaque cells
+	int col = dx / LAYOUT::CELL_WIDTH;
+	int row = dy / LAYOUT::CELL_HEIGHT;
+
+	if ((aliens.aliveInRow[row] & (Bitmask(1) << col)) != 0 &&
+		IsOpaque(AlienSpriteOfRow<LAYOUT>(row), aliens.animation, dx - LAYOUT::columnOffset[col], dy - LAYOUT::rowOffset[row]))
+	{
+		alienCollidePositionInArray.x = col;
+		alienCollidePositionInArray.y = row;
+		return true;
+	}
+
+	return false;
+}
+
+// tests the missile against every opaque cell of every living alien, IsCollision has to give the same answer
+template<class LAYOUT>
+bool IsCollisionBruteForce(const Player& player, const BasicAlienSwarm<LAYOUT>& aliens, Position& alienCollidePositionInArray)
+{
+	alienCollidePositionInArray.x = NOT_IN_PLAY;
+	alienCollidePositionInArray.y = NOT_IN_PLAY;
+
+	for (int row = 0; row < LAYOUT::NUM_ROWS; row++)
+	{
+		int y = AlienY(aliens, row);
+
+		for (Bitmask alive = aliens.aliveInRow[row]; alive != 0; alive &= alive - 1)
+		{
+			int col = LowestSetBit(alive);
+			int x = AlienX(aliens, col);
+
+			if (IsOpaque(AlienSpriteOfRow<LAYOUT>(row), aliens.animation, player.missile.x - x, player.missile.y - y))
+			{
+				alienCollidePositionInArray.x = col;
+				alienCollidePositionInArray.y = row;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// leaves the alien exploding and returns its points, when the explosion ends is up to the caller
+template<class LAYOUT>
+int ResolveAlienCollision(BasicAlienSwarm<LAYOUT>& aliens, const Position& hitPositionInAliensArray)
+{
+	SetAlienState(aliens, hitPositionInAliensArray.y, hitPositionInAliensArray.x, AS_EXPLODING);
+	aliens.numAliensLeft--;
+
+	if (aliens.lowestAlienInColumn[hitPositionInAliensArray.x] == hitPositionInAliensArray.y)
+	{
+		UpdateLowestAlien(aliens, hitPositionInAliensArray.x);
+	}
+
+	return LAYOUT::rowPoints[hitPositionInAliensArray.y];
+}
+
+// the other way round from ResolveAlienCollision, for aliens sent over in versus mode, false if the alien isn't dead
+template<class LAYOUT>
+bool ReviveAlien(BasicAlienSwarm<LAYOUT>& aliens, int row, int col)
+{
+	if (GetAlienState(aliens, row, col) != AS_DEAD)
+	{
+		return false;
+	}
+
+	SetAlienState(aliens, row, col, AS_ALIVE);
+	aliens.numAliensLeft++;
+
+	if (aliens.shooterColumnIndex[col] == NOT_IN_PLAY)
+	{
+		aliens.shooterColumnIndex[col] = aliens.numberOfShooterColumns;
+		aliens.shooterColumns[aliens.numberOfShooterColumns++] = col;
+	}
+
+	aliens.lowestAlienInColumn[col] = HighestSetBit(aliens.aliveInColumn[col]);
+
+	return true;
+}
+
+// drops a bomb from the lowest living alien in the column, false if there isn't one or every bomb is already in play
+template<class LAYOUT>
+bool ShootBomb(BasicAlienSwarm<LAYOUT>& aliens, int columnToShoot)
+{
+	int r = aliens.lowestAlienInColumn[columnToShoot];
+
+	if (r != NOT_IN_PLAY)
+	{
+		int x = AlienX(aliens, columnToShoot) + 1; // roughly middle of the alien
+		int y = AlienY(aliens, r) + LAYOUT::SPRITE_HEIGHT; // bottom of alien
+
+		return SpawnProjectile(aliens.bombs, x, y);
+	}
+
+	return false;
+}
+
+// for a swarm read from outside: the row and column masks agree and stay inside the layout, and every count and index
+// the swarm is looked up with is in range
+template<class LAYOUT>
+bool IsSwarmValid(const BasicAlienSwarm<LAYOUT>& aliens)
+{
+	Bitmask aliveInColumn[LAYOUT::NUM_COLS] = {};
+	Bitmask explodingInColumn[LAYOUT::NUM_COLS] = {};
+	Bitmask occupiedColumns = 0;
+	Bitmask occupiedRows = 0;
+	int numberOfAlive = 0;
+
+	for (int row = 0; row < LAYOUT::NUM_ROWS; row++)
+	{
+		Bitmask alive = aliens.aliveInRow[row];
+		Bitmask exploding = aliens.explodingInRow[row];
+
+		if (((alive | exploding) & ~BitRange(0, LAYOUT::NUM_COLS)) != 0 || (alive & exploding) != 0)
+		{
+			return false;
+		}
+
+		for (int col = 0; col < LAYOUT::NUM_COLS; col++)
+		{
+			aliveInColumn[col] |= Bitmask((alive >> col) & 1) << row;
+			explodingInColumn[col] |= Bitmask((exploding >> col) & 1) << row;
+		}
+
+		occupiedColumns |= alive | exploding;
+		occupiedRows |= (alive | exploding) != 0 ? Bitmask(1) << row : 0;
+		numberOfAlive += CountSetBits(alive);
+	}
+
+	if (occupiedColumns != aliens.occupiedColumns || occupiedRows != aliens.occupiedRows || numberOfAlive != aliens.numAliensLeft ||
+		aliens.numberOfShooterColumns < 0 || aliens.numberOfShooterColumns > LAYOUT::NUM_COLS ||
+		aliens.animation < 0 || aliens.animation >= AlienSprite::NUM_FRAMES ||
+		!IsProjectilePoolValid(aliens.bombs, ALIEN_BOMB_SPRITE.NUM_FRAMES))
+	{
+		return false;
+	}
+
+	for (int col = 0; col < LAYOUT::NUM_COLS; col++)
+	{
+		int lowest = aliens.lowestAlienInColumn[col];
+		int index = aliens.shooterColumnIndex[col];
+
+		if (aliveInColumn[col] != aliens.aliveInColumn[col] || explodingInColumn[col] != aliens.explodingInColumn[col] ||
+			lowest < NOT_IN_PLAY || lowest >= LAYOUT::NUM_ROWS ||
+			index < NOT_IN_PLAY || index >= aliens.numberOfShooterColumns)
+		{
+			return false;
+		}
+	}
+
+	for (int i = 0; i < aliens.numberOfShooterColumns; i++)
+	{
+		int col = aliens.shooterColumns[i];
+
+		if (col < 0 || col >= LAYOUT::NUM_COLS || aliens.shooterColumnIndex[col] != i)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,211 @@
+#include "AnsiBuffer.h"
+#include <cstring>
+#include <algorithm>
+
+const int MAX_CURSOR_MOVE_LENGTH = 16; // ESC [ row ; col H with two big numbers fits easily
+
+int CursorMoveSequence(const AnsiBuffer& buffer, int xPos, int yPos, char* sequence);
+int ControlSequence(char* sequence, int firstNumber, int secondNumber, char command);
+int CursorForwardLength(int columns);
+int AppendNumber(char* out, int number);
+
+void InitAnsiBuffer(AnsiBuffer& buffer, int width, int height, bool ownsFrame)
+{
+	buffer.width = width;
+	buffer.height = height;
+	buffer.screen.assign(width * height, ' ');
+	buffer.frame.assign(ownsFrame ? width * height : 0, ' ');
+
+	// the worst a frame can need: every cell, plus a cursor move in front of every run. Gaps of 4 or less
+	// are cheaper to resend than to jump over, so a row can't hold more than one run per 6 columns.
+	int maxRunsPerRow = (width + 5) / 6 + 1;
+	buffer.output.resize(height * (width + maxRunsPerRow * MAX_CURSOR_MOVE_LENGTH) + MAX_CURSOR_MOVE_LENGTH);
+	buffer.outputLength = 0;
+
+	buffer.cursorX = -1;
+	buffer.cursorY = -1;
+	buffer.fullRedraw = false;
+}
+
+void AnsiClear(AnsiBuffer& buffer)
+{
+	std::fill(buffer.frame.begin(), buffer.frame.end(), ' ');
+	buffer.fullRedraw = true;
+}
+
+void AnsiRedrawAll(AnsiBuffer& buffer)
+{
+	buffer.fullRedraw = true;
+}
+
+void AnsiDrawCharacter(AnsiBuffer& buffer, int xPos, int yPos, char aCharacter)
+{
+	if (xPos >= 0 && xPos < buffer.width && yPos >= 0 && yPos < buffer.height)
+	{
+		buffer.frame[yPos * buffer.width + xPos] = aCharacter;
+	}
+}
+
+void AnsiDrawString(AnsiBuffer& buffer, int xPos, int yPos, const char* aString, int length)
+{
+	if (yPos < 0 || yPos >= buffer.height)
+	{
+		return;
+	}
+
+	int first = xPos < 0 ? -xPos : 0;
+	int last = std::min(length, buffer.width - xPos);
+
+	if (first < last)
+	{
+		memcpy(&buffer.frame[yPos * buffer.width + xPos + first], aString + first, last - first);
+	}
+}
+
+int ComposeAnsiFrame(AnsiBuffer& buffer)
+{
+	return ComposeAnsiFrame(buffer, buffer.frame.data());
+}
+
+int ComposeAnsiFrame(AnsiBuffer& buffer, const char* nextFrame)
+{
+	char* out = buffer.output.data();
+
+	if (buffer.fullRedraw)
+	{
+		const char CLEAR_SCREEN[] = "\x1b[H\x1b[2J";
+		memcpy(out, CLEAR_SCREEN, sizeof(CLEAR_SCREEN) - 1);
+		out += sizeof(CLEAR_SCREEN) - 1;
+
+		std::fill(buffer.screen.begin(), buffer.screen.end(), ' ');
+		buffer.cursorX = 0;
+		buffer.cursorY = 0;
+		buffer.fullRedraw = false;
+	}
+
+	for (int y = 0; y < buffer.height; y++)
+	{
+		char* screen = &buffer.screen[y * buffer.width];
+		const char* frame = &nextFrame[y * buffer.width];
+
+		int x = 0;
+		while (x < buffer.width)
+		{
+			if (screen[x] == frame[x])
+			{
+				x++;
+				continue;
+			}
+
+			// extend the run over unchanged gaps that are cheaper to resend than to skip with a cursor move
+			int runEnd = x + 1;
+			for (int next = runEnd; next < buffer.width; next++)
+			{
+				if (screen[next] != frame[next])
+				{
+					runEnd = next + 1;
+				}
+				else if (next + 1 - runEnd > CursorForwardLength(next + 1 - runEnd))
+				{
+					break;
+				}
+			}
+
+			out += CursorMoveSequence(buffer, x, y, out);
+
+			memcpy(out, frame + x, runEnd - x);
+			memcpy(screen + x, frame + x, runEnd - x);
+			out += runEnd - x;
+
+			// writing the last column leaves the cursor in a state terminals disagree on, so forget where it is
+			buffer.cursorX = runEnd < buffer.width ? runEnd : -1;
+			buffer.cursorY = runEnd < buffer.width ? y : -1;
+
+			x = runEnd;
+		}
+	}
+
+	buffer.outputLength = int(out - buffer.output.data());
+	return buffer.outputLength;
+}
+
+// writes the shortest sequence that takes the cursor from where it is to (xPos, yPos), returns its length
+int CursorMoveSequence(const AnsiBuffer& buffer, int xPos, int yPos, char* sequence)
+{
+	if (buffer.cursorX == xPos && buffer.cursorY == yPos)
+	{
+		return 0;
+	}
+
+	if (buffer.cursorY == yPos && buffer.cursorX >= 0)
+	{
+		if (xPos == 0)
+		{
+			sequence[0] = '\r';
+			return 1;
+		}
+
+		if (xPos > buffer.cursorX)
+		{
+			int columns = xPos - buffer.cursorX;
+			return ControlSequence(sequence, columns > 1 ? columns : 0, 0, 'C');
+		}
+	}
+
+	// absolute move, rows and columns count from 1 and a column of 1 can be left out
+	return ControlSequence(sequence, yPos + 1, xPos > 0 ? xPos + 1 : 0, 'H');
+}
+
+// ESC [ first ; second command, leaving out numbers that are 0
+int ControlSequence(char* sequence, int firstNumber, int secondNumber, char command)
+{
+	char* out = sequence;
+	*out++ = '\x1b';
+	*out++ = '[';
+
+	if (firstNumber > 0)
+	{
+		out += AppendNumber(out, firstNumber);
+	}
+
+	if (secondNumber > 0)
+	{
+		*out++ = ';';
+		out += AppendNumber(out, secondNumber);
+	}
+
+	*out++ = command;
+	return int(out - sequence);
+}
+
+// length of ESC [ columns C, the count is left out when it is 1
+int CursorForwardLength(int columns)
+{
+	int length = 3;
+
+	for (int n = columns; columns > 1 && n > 0; n /= 10)
+	{
+		length++;
+	}
+
+	return length;
+}
+
+int AppendNumber(char* out, int number)
+{
+	char digits[12];
+	int numberOfDigits = 0;
+
+	do
+	{
+		digits[numberOfDigits++] = char('0' + number % 10);
+		number /= 10;
+	} while (number > 0);
+
+	for (int i = 0; i < numberOfDigits; i++)
+	{
+		out[i] = digits[numberOfDigits - 1 - i];
+	}
+
+	return numberOfDigits;
+}
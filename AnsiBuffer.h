@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+
+// A screen of characters that turns itself into the ANSI escape codes to bring a terminal up to date.
+// Characters are drawn into frame, ComposeAnsiFrame compares it against what the terminal is showing
+// and writes the changes, with the shortest cursor moves it can, into a buffer allocated once up front.
+// Sending the bytes is up to the caller, so the same buffer serves a local terminal or a socket.
+
+struct AnsiBuffer
+{
+	int width;
+	int height;
+	std::vector<char> screen; // what the terminal is showing
+	std::vector<char> frame; // what it should be showing after the next ComposeAnsiFrame, empty if the frames come from elsewhere
+	std::vector<char> output; // escape codes and characters for the last ComposeAnsiFrame, never reallocated
+	int outputLength;
+	int cursorX; // where the terminal's cursor is, -1 when we can't be sure
+	int cursorY;
+	bool fullRedraw; // clear the terminal and resend everything on the next ComposeAnsiFrame
+};
+
+void InitAnsiBuffer(AnsiBuffer& buffer, int width, int height, bool ownsFrame = true);
+
+void AnsiClear(AnsiBuffer& buffer); // blanks the frame and redraws the whole terminal next time, like curses clear()
+void AnsiRedrawAll(AnsiBuffer& buffer); // keeps the frame but redraws the whole terminal next time, for a terminal in an unknown state
+
+void AnsiDrawCharacter(AnsiBuffer& buffer, int xPos, int yPos, char aCharacter);
+void AnsiDrawString(AnsiBuffer& buffer, int xPos, int yPos, const char* aString, int length);
+
+int ComposeAnsiFrame(AnsiBuffer& buffer); // returns the number of bytes in buffer.output
+int ComposeAnsiFrame(AnsiBuffer& buffer, const char* frame); // the same from a width * height frame drawn somewhere else, like a Renderer's back buffer
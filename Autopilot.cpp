@@ -0,0 +1,185 @@
+#include "Autopilot.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std::chrono;
+
+// the inputs the autopilot chooses between, a tie goes to the earliest
+const int AUTOPILOT_INPUTS[] = { GI_FIRE, GI_LEFT | GI_FIRE, GI_RIGHT | GI_FIRE, GI_NONE, GI_LEFT, GI_RIGHT };
+const int NUM_AUTOPILOT_INPUTS = sizeof(AUTOPILOT_INPUTS) / sizeof(AUTOPILOT_INPUTS[0]);
+
+const double AUTOPILOT_HIT_PENALTY = 1000.0; // for each time the player is hit, more than a rollout could ever score
+const double AUTOPILOT_DISCOUNT = 0.97; // a point scored a tick later is worth this much of one scored now
+const double AUTOPILOT_DISTANCE_PENALTY = 0.01; // for each column the player ends up away from the nearest alien that can shoot
+
+void RunAutopilotBatch(const GameWorld& world, int input, int depth, int rollouts, uint64_t seed, int stream,
+	steady_clock::time_point deadline, AutopilotTally& tally);
+double RunRollout(const GameWorld& world, int firstInput, int depth, Random& random);
+int DistanceToShooter(const GameWorld& world);
+
+void InitAutopilot(Autopilot& autopilot, uint64_t seed, int rolloutsPerInput, int depth)
+{
+	autopilot.rolloutsPerInput = std::max(rolloutsPerInput, 1);
+	autopilot.depth = std::max(depth, 1);
+	autopilot.seed = seed;
+	autopilot.tallies.clear();
+	autopilot.lastRollouts = 0;
+	autopilot.lastMicroseconds = 0;
+}
+
+int ChooseAutopilotInput(Autopilot& autopilot, const GameWorld& world, ThreadPool* pool, steady_clock::time_point deadline)
+{
+	PROFILE_SCOPE("ChooseAutopilotInput");
+
+	if (world.game.currentState != GS_PLAY)
+	{
+		autopilot.lastRollouts = 0;
+		autopilot.lastMicroseconds = 0;
+		return GI_FIRE; // all there is to do while the player is dead is press fire to carry on
+	}
+
+	steady_clock::time_point startTime = steady_clock::now();
+
+	const int batchesPerInput = (autopilot.rolloutsPerInput + AUTOPILOT_ROLLOUTS_PER_TASK - 1) / AUTOPILOT_ROLLOUTS_PER_TASK;
+	const int numberOfBatches = batchesPerInput * NUM_AUTOPILOT_INPUTS;
+	const int depth = autopilot.depth;
+	const uint64_t seed = autopilot.seed ^ uint64_t(world.game.stats.frames) * 0x9e3779b97f4a7c15ULL; // different rollouts every tick
+
+	autopilot.tallies.assign(numberOfBatches, AutopilotTally());
+
+	// round robin over the inputs, so if the deadline cuts the rollouts short every input has had about as many
+	for (int batch = 0; batch < numberOfBatches; batch++)
+	{
+		int input = AUTOPILOT_INPUTS[batch % NUM_AUTOPILOT_INPUTS];
+		int rollouts = std::min(int(AUTOPILOT_ROLLOUTS_PER_TASK), autopilot.rolloutsPerInput - batch / NUM_AUTOPILOT_INPUTS * AUTOPILOT_ROLLOUTS_PER_TASK);
+		AutopilotTally* tally = &autopilot.tallies[batch];
+
+		if (pool != NULL)
+		{
+			SubmitTask(*pool, [&world, input, depth, rollouts, seed, batch, deadline, tally]
+			{
+				RunAutopilotBatch(world, input, depth, rollouts, seed, batch, deadline, *tally);
+			});
+		}
+		else
+		{
+			RunAutopilotBatch(world, input, depth, rollouts, seed, batch, deadline, *tally);
+		}
+	}
+
+	if (pool != NULL)
+	{
+		WaitForTasks(*pool);
+	}
+
+	double totals[NUM_AUTOPILOT_INPUTS] = {};
+	int rollouts[NUM_AUTOPILOT_INPUTS] = {};
+
+	for (int batch = 0; batch < numberOfBatches; batch++)
+	{
+		totals[batch % NUM_AUTOPILOT_INPUTS] += autopilot.tallies[batch].total;
+		rollouts[batch % NUM_AUTOPILOT_INPUTS] += autopilot.tallies[batch].rollouts;
+	}
+
+	int best = NOT_IN_PLAY;
+	double bestValue = 0;
+	autopilot.lastRollouts = 0;
+
+	for (int i = 0; i < NUM_AUTOPILOT_INPUTS; i++)
+	{
+		autopilot.lastRollouts += rollouts[i];
+
+		if (rollouts[i] > 0 && (best == NOT_IN_PLAY || totals[i] / rollouts[i] > bestValue))
+		{
+			best = i;
+			bestValue = totals[i] / rollouts[i];
+		}
+	}
+
+	autopilot.lastMicroseconds = int(duration_cast<microseconds>(steady_clock::now() - startTime).count());
+
+	return best != NOT_IN_PLAY ? AUTOPILOT_INPUTS[best] : GI_FIRE;
+}
+
+// stream keeps the batches' random numbers apart
+void RunAutopilotBatch(const GameWorld& world, int input, int depth, int rollouts, uint64_t seed, int stream,
+	steady_clock::time_point deadline, AutopilotTally& tally)
+{
+	PROFILE_PAUSE(); // the rollouts step the real game's timed phases thousands of times, they'd drown out the real tick
+
+	Random random;
+	SeedRandom(random, seed, stream);
+
+	for (int i = 0; i < rollouts && steady_clock::now() < deadline; i++)
+	{
+		tally.total += RunRollout(world, input, depth, random);
+		tally.rollouts++;
+	}
+}
+
+double RunRollout(const GameWorld& world, int firstInput, int depth, Random& random)
+{
+	GameWorld rollout = world;
+	SeedRandom(rollout.game.random, uint64_t(NextRandom(random)) << 32 | NextRandom(random));
+
+	double value = 0;
+	double weight = 1;
+	int move = GI_NONE;
+	int moveTicks = 0;
+
+	for (int tick = 0; tick < depth; tick++)
+	{
+		int input = firstInput;
+
+		if (tick >= AUTOPILOT_HOLD_TICKS)
+		{
+			// a random walk that keeps going the same way for a while, so it covers some ground instead of jittering
+			if (moveTicks == 0)
+			{
+				int choice = RandomInt(random, 3);
+				move = choice == 0 ? GI_NONE : choice == 1 ? GI_LEFT : GI_RIGHT;
+				moveTicks = 1 + RandomInt(random, 8);
+			}
+
+			moveTicks--;
+			input = move | GI_FIRE;
+		}
+
+		int scoreBefore = rollout.player.score;
+		int hitsBefore = rollout.game.stats.playerHits;
+
+		StepGameWorld(rollout, input);
+
+		value += weight * (rollout.player.score - scoreBefore);
+		value -= weight * AUTOPILOT_HIT_PENALTY * (rollout.game.stats.playerHits - hitsBefore);
+
+		if (rollout.aliens.occupiedColumns == 0)
+		{
+			return value; // nothing left to shoot
+		}
+
+		weight *= AUTOPILOT_DISCOUNT;
+	}
+
+	// with nothing scored either way, better to have ended up under something to shoot at
+	return value - weight * AUTOPILOT_DISTANCE_PENALTY * DistanceToShooter(rollout);
+}
+
+// columns from the middle of the player to the middle of the nearest alien that can shoot, 0 if none can
+int DistanceToShooter(const GameWorld& world)
+{
+	const AlienSwarm& aliens = world.aliens;
+	int playerX = world.player.position.x + world.player.spriteSize.width / 2;
+	int distance = 0;
+
+	for (int i = 0; i < aliens.numberOfShooterColumns; i++)
+	{
+		int alienX = AlienX(aliens, aliens.shooterColumns[i]) + AlienSwarm::Layout::SPRITE_WIDTH / 2;
+		int columns = abs(alienX - playerX);
+
+		distance = i == 0 ? columns : std::min(distance, columns);
+	}
+
+	return distance;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "GameWorld.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <vector>
+
+// A player that picks each tick's input by playing the game forward. Every candidate input is tried in a number of
+// rollouts: a copy of the world that holds the input for a few ticks, then moves about at random firing whenever it can,
+// stepped with StepGameWorld like the real game. A rollout scores the points it makes, sooner counting for more, and
+// loses heavily if a bomb hits the player, so the input with the best average aims for aliens and keeps out of the way
+// of bombs. Each rollout reseeds its copy's random numbers, so it plans against the swarm's possible futures rather
+// than the one the real game's seed will pick. The rollouts are spread over a ThreadPool in small batches, round robin
+// over the inputs, and any still to start at the deadline are dropped, so a decision always fits in its frame.
+
+enum
+{
+	AUTOPILOT_ROLLOUTS = 128, // for each candidate input
+	AUTOPILOT_DEPTH = 48, // ticks each rollout plays, about as long as a missile takes to reach the swarm and a bomb the player
+	AUTOPILOT_HOLD_TICKS = 4, // how long a rollout holds the input it is testing before moving at random
+	AUTOPILOT_ROLLOUTS_PER_TASK = 16
+};
+
+struct AutopilotTally
+{
+	double total; // the values of the rollouts that ran
+	int rollouts;
+};
+
+struct Autopilot
+{
+	int rolloutsPerInput;
+	int depth;
+	uint64_t seed; // the same seed, world and settings give the same decision, as long as nothing is dropped at the deadline
+	std::vector<AutopilotTally> tallies; // one for each batch of rollouts, kept so deciding doesn't allocate them every tick
+
+	// how the last decision went
+	int lastRollouts;
+	int lastMicroseconds;
+};
+
+void InitAutopilot(Autopilot& autopilot, uint64_t seed, int rolloutsPerInput = AUTOPILOT_ROLLOUTS, int depth = AUTOPILOT_DEPTH);
+
+// GameInput flags for the next tick. The rollouts run on the pool, or on this thread if it is NULL
+int ChooseAutopilotInput(Autopilot& autopilot, const GameWorld& world, ThreadPool* pool,
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
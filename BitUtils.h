@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// one bit per cell of a row or column, so grids can be up to 64 cells wide or high
+typedef uint64_t Bitmask;
+
+const int BITMASK_BITS = 64;
+
+// index of the lowest set bit, mask must not be 0
+inline int LowestSetBit(Bitmask mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return int(index);
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+// index of the highest set bit, mask must not be 0
+inline int HighestSetBit(Bitmask mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, mask);
+	return int(index);
+#else
+	return BITMASK_BITS - 1 - __builtin_clzll(mask);
+#endif
+}
+
+inline int CountSetBits(Bitmask mask)
+{
+#if defined(_MSC_VER)
+	return int(__popcnt64(mask));
+#else
+	return __builtin_popcountll(mask);
+#endif
+}
+
+// mask with the bits [first, first + count) set
+inline Bitmask BitRange(int first, int count)
+{
+	return count >= BITMASK_BITS ? ~Bitmask(0) << first : ((Bitmask(1) << count) - 1) << first;
+}
@@ -1,7 +1,25 @@
 #include "CursesUtils.h"
+#include "AnsiBuffer.h"
+#include <cstring>
+#include <cerrno>
 
+#ifdef _WIN32
+#include <io.h>
+#define write _write
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
 
-void InitializeCurses(bool noDelay)
+// state for OB_ANSI, curses keeps its own
+OutputBackend outputBackend = OB_CURSES;
+AnsiBuffer ansiBuffer;
+int ansiOutputFile = -1;
+
+void StartAnsiOutput(int outputFile);
+int WriteAll(int file, const char* data, int length);
+
+void InitializeCurses(bool noDelay, OutputBackend backend)
 {
 	initscr();
 	noecho();
@@ -9,21 +27,101 @@ void InitializeCurses(bool noDelay)
 
 	nodelay(stdscr, noDelay);
 	keypad(stdscr, true);
+
+	outputBackend = backend;
+	if (backend == OB_ANSI)
+	{
+		StartAnsiOutput(fileno(stdout));
+	}
+}
+
+bool InitializeOffscreenCurses(FILE* output, FILE* input, int width, int height, OutputBackend backend)
+{
+	// always the same terminal type so byte counts compare between machines
+	SCREEN* screen = newterm("xterm", output, input);
+	if (screen == NULL)
+	{
+		return false;
+	}
+
+	set_term(screen);
+	resize_term(height, width);
+	noecho();
+	curs_set(false);
+
+	outputBackend = backend;
+	if (backend == OB_ANSI)
+	{
+		StartAnsiOutput(fileno(output));
+	}
+
+	return true;
+}
+
+// curses still owns the terminal modes and the keyboard. We let it clear the screen once and then never touch stdscr,
+// so getch has nothing to refresh and everything else on the screen comes from us.
+void StartAnsiOutput(int outputFile)
+{
+	refresh();
+
+	InitAnsiBuffer(ansiBuffer, COLS, LINES);
+	ansiOutputFile = outputFile;
 }
 
 void ShutdownCurses()
 {
 	endwin();
+	outputBackend = OB_CURSES;
 }
 
 void ClearScreen()
 {
-	clear();
+	if (outputBackend == OB_ANSI)
+	{
+		AnsiClear(ansiBuffer);
+	}
+	else
+	{
+		clear();
+	}
 }
 
-void RefreshScreen()
+int RefreshScreen()
 {
+	if (outputBackend == OB_ANSI)
+	{
+		return WriteAll(ansiOutputFile, ansiBuffer.output.data(), ComposeAnsiFrame(ansiBuffer));
+	}
+
 	refresh();
+	return -1;
+}
+
+// returns how much of data was written before an error, if there was one
+int WriteAll(int file, const char* data, int length)
+{
+	int total = 0;
+
+	while (length > 0)
+	{
+		int written = int(write(file, data, length));
+		if (written <= 0)
+		{
+			if (written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			AnsiRedrawAll(ansiBuffer); // we've lost track of what the terminal shows, start over next frame
+			return total;
+		}
+
+		data += written;
+		length -= written;
+		total += written;
+	}
+
+	return total;
 }
 
 int ScreenWidth()
@@ -41,21 +139,40 @@ int GetChar()
 	return getch();
 }
 
-void DrawCharacter(int xPos, int yPos, char aCharacter)
+int GetCharTimeout(int milliseconds)
 {
-	mvaddch(yPos, xPos, aCharacter);
+	timeout(milliseconds);
+	return getch();
 }
 
-void MoveCursor(int xPos, int yPos)
+void DrawCharacter(int xPos, int yPos, char aCharacter)
 {
-	move(yPos, xPos);
+	if (outputBackend == OB_ANSI)
+	{
+		AnsiDrawCharacter(ansiBuffer, xPos, yPos, aCharacter);
+	}
+	else
+	{
+		mvaddch(yPos, xPos, aCharacter);
+	}
 }
 
-void DrawSprite(int xPos, int yPos, const char* sprite[], int spriteHeight, int offset)
+void DrawString(int xPos, int yPos, const char* aString, int length)
 {
-	for (int h = 0; h < spriteHeight; h++)
+	if (outputBackend == OB_ANSI)
 	{
-		mvprintw(yPos + h, xPos,"%s", sprite[h+offset]);
+		AnsiDrawString(ansiBuffer, xPos, yPos, aString, length);
+	}
+	else
+	{
+		mvaddnstr(yPos, xPos, aString, length);
 	}
 }
 
+void MoveCursor(int xPos, int yPos)
+{
+	if (outputBackend == OB_CURSES) // the cursor is hidden, ComposeAnsiFrame moves it wherever it needs to
+	{
+		move(yPos, xPos);
+	}
+}
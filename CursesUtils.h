@@ -1,6 +1,8 @@
 #pragma once
 
 #include "curses.h"
+#include "Sprite.h"
+#include <cstdio>
 
 enum ArrowKeys
 {
@@ -10,18 +12,39 @@ enum ArrowKeys
 	AK_RIGHT = KEY_RIGHT
 };
 
-void InitializeCurses(bool nodelay);
+// Curses always reads the keyboard. Drawing goes either through curses, or with OB_ANSI straight to the terminal
+// as ANSI escape codes, composed in one buffer and sent with a single write per RefreshScreen.
+enum OutputBackend
+{
+	OB_CURSES = 0,
+	OB_ANSI
+};
+
+void InitializeCurses(bool nodelay, OutputBackend backend = OB_CURSES);
+bool InitializeOffscreenCurses(FILE* output, FILE* input, int width, int height, OutputBackend backend = OB_CURSES); // for benchmarks, everything meant for the terminal goes to output
 void ShutdownCurses();
 
 void ClearScreen();
-void RefreshScreen();
+int RefreshScreen(); // bytes written to the terminal with OB_ANSI, -1 with curses, which doesn't say
 
 int ScreenWidth();
 int ScreenHeight();
 
 int GetChar();
+int GetCharTimeout(int milliseconds); // blocks until a key arrives or the timeout expires (returns ERR)
 
 void DrawCharacter(int xPos, int yPos, char aCharacter);
+void DrawString(int xPos, int yPos, const char* aString, int length);
 void MoveCursor(int xPos, int yPos);
 
-void DrawSprite(int xPos, int yPos, const char* sprite[], int spriteHeight, int offset = 0);
+template<int WIDTH, int HEIGHT, int FRAMES>
+void DrawSprite(int xPos, int yPos, const Sprite<WIDTH, HEIGHT, FRAMES>& sprite, int frame = 0)
+{
+	for (int h = 0; h < HEIGHT; h++)
+	{
+		int row = frame * HEIGHT + h;
+		int start = sprite.runStart[row];
+
+		DrawString(xPos + start, yPos + h, sprite.cells[row] + start, sprite.runLength[row]);
+	}
+}
@@ -0,0 +1,148 @@
+#include "FrameBroadcast.h"
+#include <algorithm>
+#include <cerrno>
+#include <sys/socket.h>
+
+FramePacket MakeFramePacket(const AnsiBuffer& buffer);
+void DropQueuedFrames(Viewer& viewer);
+
+void InitViewer(Viewer& viewer, int socket)
+{
+	viewer.socket = socket;
+	viewer.queue.clear();
+	viewer.sentOfFirst = 0;
+	viewer.queuedBytes = 0;
+	viewer.needsKeyframe = true;
+	viewer.closing = false;
+}
+
+void InitFrameBroadcast(FrameBroadcast& broadcast, int width, int height)
+{
+	InitAnsiBuffer(broadcast.stream, width, height, false);
+	InitAnsiBuffer(broadcast.keyframe, width, height, false);
+	broadcast.viewers.clear();
+}
+
+void AddViewer(FrameBroadcast& broadcast, Viewer* viewer)
+{
+	viewer->needsKeyframe = true;
+	broadcast.viewers.push_back(viewer);
+}
+
+void RemoveViewer(FrameBroadcast& broadcast, Viewer* viewer)
+{
+	broadcast.viewers.erase(std::remove(broadcast.viewers.begin(), broadcast.viewers.end(), viewer), broadcast.viewers.end());
+}
+
+long long BroadcastFrame(FrameBroadcast& broadcast, const char* frame)
+{
+	if (broadcast.viewers.empty())
+	{
+		return 0;
+	}
+
+	// each delta starts with an absolute cursor move, so it is correct after a keyframe as well as after the delta before it
+	broadcast.stream.cursorX = -1;
+	broadcast.stream.cursorY = -1;
+
+	FramePacket delta;
+	if (ComposeAnsiFrame(broadcast.stream, frame) > 0)
+	{
+		delta = MakeFramePacket(broadcast.stream);
+	}
+
+	FramePacket keyframe;
+	long long bytesSent = 0;
+
+	for (Viewer* viewer : broadcast.viewers)
+	{
+		if (viewer->needsKeyframe)
+		{
+			// encoded at most once a frame, however many viewers want it
+			if (!keyframe)
+			{
+				AnsiRedrawAll(broadcast.keyframe);
+				ComposeAnsiFrame(broadcast.keyframe, frame);
+				keyframe = MakeFramePacket(broadcast.keyframe);
+			}
+
+			DropQueuedFrames(*viewer);
+			viewer->queue.push_back(keyframe);
+			viewer->queuedBytes += int(keyframe->size());
+			viewer->needsKeyframe = false;
+		}
+		else if (delta)
+		{
+			viewer->queue.push_back(delta);
+			viewer->queuedBytes += int(delta->size());
+		}
+
+		bytesSent += SendQueuedFrames(*viewer);
+
+		// too far behind to ever catch up, skip what's queued and start again from a keyframe next frame
+		if (viewer->queuedBytes > MAX_VIEWER_QUEUED_BYTES)
+		{
+			viewer->needsKeyframe = true;
+		}
+	}
+
+	return bytesSent;
+}
+
+FramePacket MakeFramePacket(const AnsiBuffer& buffer)
+{
+	return std::make_shared<const std::vector<char>>(buffer.output.begin(), buffer.output.begin() + buffer.outputLength);
+}
+
+// forgets every queued frame except one that is partly sent, cutting that off halfway through an escape code would garble the terminal
+void DropQueuedFrames(Viewer& viewer)
+{
+	while (viewer.queue.size() > (viewer.sentOfFirst > 0 ? 1u : 0u))
+	{
+		viewer.queuedBytes -= int(viewer.queue.back()->size());
+		viewer.queue.pop_back();
+	}
+}
+
+int SendQueuedFrames(Viewer& viewer)
+{
+	int bytesSent = 0;
+
+	while (!viewer.queue.empty())
+	{
+		const std::vector<char>& packet = *viewer.queue.front();
+
+		ssize_t sent = send(viewer.socket, packet.data() + viewer.sentOfFirst, packet.size() - viewer.sentOfFirst, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		if (sent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				viewer.closing = true;
+			}
+
+			break;
+		}
+
+		bytesSent += int(sent);
+		viewer.sentOfFirst += int(sent);
+
+		if (viewer.sentOfFirst == int(packet.size()))
+		{
+			viewer.queuedBytes -= int(packet.size());
+			viewer.queue.pop_front();
+			viewer.sentOfFirst = 0;
+		}
+		else
+		{
+			break; // the socket is full
+		}
+	}
+
+	return bytesSent;
+}
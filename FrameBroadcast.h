@@ -0,0 +1,41 @@
+#pragma once
+#include "AnsiBuffer.h"
+#include <memory>
+#include <vector>
+#include <deque>
+
+// Sends one game's screen to any number of viewers on non-blocking sockets.
+// Every frame is encoded once as a delta against the previous one, and every viewer is handed the same bytes,
+// so the cost of a frame is the size of what changed, not the number of viewers times the size of the screen.
+// A viewer joining late, or falling so far behind that its queue is dropped, is sent one full keyframe
+// and then carries on with the deltas like everyone else.
+
+typedef std::shared_ptr<const std::vector<char>> FramePacket;
+
+const int MAX_VIEWER_QUEUED_BYTES = 64 * 1024; // a viewer further behind than this skips ahead to the next keyframe
+
+struct Viewer
+{
+	int socket;
+	std::deque<FramePacket> queue; // encoded frames the socket hasn't taken yet, oldest first
+	int sentOfFirst; // bytes of the oldest frame already sent
+	int queuedBytes;
+	bool needsKeyframe;
+	bool closing; // the socket failed, the owner should drop this viewer
+};
+
+struct FrameBroadcast
+{
+	AnsiBuffer stream; // what a viewer that has kept up with every delta is showing
+	AnsiBuffer keyframe; // scratch for encoding full frames
+	std::vector<Viewer*> viewers;
+};
+
+void InitViewer(Viewer& viewer, int socket);
+void InitFrameBroadcast(FrameBroadcast& broadcast, int width, int height);
+
+void AddViewer(FrameBroadcast& broadcast, Viewer* viewer);
+void RemoveViewer(FrameBroadcast& broadcast, Viewer* viewer);
+
+long long BroadcastFrame(FrameBroadcast& broadcast, const char* frame); // returns the bytes the sockets took
+int SendQueuedFrames(Viewer& viewer);
@@ -0,0 +1,83 @@
+#include "GameDraw.h"
+#include "Profiler.h"
+
+void DrawGame(Renderer& renderer, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens)
+{
+	PROFILE_SCOPE("DrawGame");
+
+	if (game.currentState == GS_PLAY || game.currentState == GS_PLAYER_DEAD || game.currentState == GS_WAIT)
+	{
+		DrawPlayer(renderer, player, game.currentState == GS_PLAYER_DEAD);
+
+		DrawShields(renderer, shields, numberOfShields);
+		DrawAliens(renderer, aliens);
+	}
+	
+}
+
+void DrawPlayer(Renderer& renderer, const Player& player, bool exploding)
+{
+	if (exploding)
+	{
+		RenderSprite(renderer, player.position.x, player.position.y, PLAYER_EXPLOSION_SPRITE, player.animation);
+	}
+	else
+	{
+		RenderSprite(renderer, player.position.x, player.position.y, PLAYER_SPRITE);
+	}
+
+	if (player.missile.x != NOT_IN_PLAY)
+	{
+		RenderCharacter(renderer, player.missile.x, player.missile.y, PLAYER_MISSILE_SPRITE.cells[0][0]);
+	}
+}
+
+void DrawShields(Renderer& renderer, const Shield shields[], int numberOfShields)
+{
+	for (int i = 0; i < numberOfShields; i++)
+	{
+		const Shield& shield = shields[i];
+
+		for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+		{
+			char cells[SHIELD_SPRITE_WIDTH];
+
+			for (int x = 0; x < SHIELD_SPRITE_WIDTH; x++)
+			{
+				cells[x] = (shield.rows[row] >> x & 1) ? SHIELD_SPRITE.cells[row][x] : ' ';
+			}
+
+			RenderString(renderer, shield.position.x, shield.position.y + row, cells, SHIELD_SPRITE_WIDTH);
+		}
+	}
+}
+
+void DrawAliens(Renderer& renderer, const AlienSwarm& aliens)
+{
+	typedef AlienSwarm::Layout Layout;
+
+	for (int row = 0; row < Layout::NUM_ROWS; row++)
+	{
+		int y = AlienY(aliens, row);
+		const AlienSprite& sprite = AlienSpriteOfRow<Layout>(row);
+
+		for (int col = 0; col < Layout::NUM_COLS; col++)
+		{
+			AlienState state = GetAlienState(aliens, row, col);
+
+			if (state == AS_ALIVE)
+			{
+				RenderSprite(renderer, AlienX(aliens, col), y, sprite, aliens.animation);
+			}
+			else if (state == AS_EXPLODING)
+			{
+				RenderSprite(renderer, AlienX(aliens, col), y, ALIEN_EXPLOSION);
+			}
+		}
+	}
+
+	for (int i = 0; i < aliens.bombs.count; i++)
+	{
+		RenderCharacter(renderer, aliens.bombs.x[i], aliens.bombs.y[i], ALIEN_BOMB_SPRITE.cells[aliens.bombs.animation[i]][0]);
+	}
+}
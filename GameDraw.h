@@ -0,0 +1,11 @@
+#pragma once
+#include "GameWorld.h"
+#include "Renderer.h"
+
+// Draws the game into a Renderer's back buffer. Nothing reaches the terminal until PresentFrame,
+// so the same code draws the curses front end and offscreen targets like the benchmarks.
+
+void DrawGame(Renderer& renderer, const Game& game, const Player& player, const Shield shields[], int numberOfShields, const AlienSwarm& aliens);
+void DrawPlayer(Renderer& renderer, const Player& player, bool exploding);
+void DrawShields(Renderer& renderer, const Shield shields[], int numberOfShields);
+void DrawAliens(Renderer& renderer, const AlienSwarm& aliens);
@@ -0,0 +1,542 @@
+#include "GameWorld.h"
+#include "Profiler.h"
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+void InitGameWorld(GameWorld& world, const Size& boardSize, uint64_t seed)
+{
+	memset(&world, 0, sizeof(world)); // so everything the Init functions don't set, like unused bombs, is the same in every world
+	InitGame(world.game, boardSize, seed);
+	InitPlayer(world.game, world.player);
+	InitShields(world.game, world.shields, NUM_SHIELDS);
+	InitAliens(world.game, world.aliens);
+}
+
+void StepGameWorld(GameWorld& world, int input)
+{
+	HandleGameInput(world.game, world.player, input);
+	UpdateGame(world.game, world.player, world.shields, NUM_SHIELDS, world.aliens);
+}
+
+uint64_t HashWord(uint64_t hash, uint64_t word)
+{
+	// FNV-1a style, a word at a time, with a shift to fold the high bits back down
+	hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+	return hash ^ (hash >> 32);
+}
+
+uint64_t HashGameWorld(const GameWorld& world)
+{
+	const int NUM_LANES = 4; // independent hashes over every fourth word, so the multiplies don't wait on each other
+	const int NUM_WORDS = sizeof(world) / sizeof(uint64_t);
+
+	const unsigned char* bytes = (const unsigned char*)&world;
+	uint64_t lanes[NUM_LANES] = { 14695981039346656037ULL, 1, 2, 3 };
+	uint64_t word;
+
+	int i = 0;
+	for (; i + NUM_LANES <= NUM_WORDS; i += NUM_LANES)
+	{
+		for (int lane = 0; lane < NUM_LANES; lane++)
+		{
+			memcpy(&word, bytes + (i + lane) * sizeof(word), sizeof(word));
+			lanes[lane] = HashWord(lanes[lane], word);
+		}
+	}
+
+	for (; i < NUM_WORDS; i++)
+	{
+		memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+		lanes[0] = HashWord(lanes[0], word);
+	}
+
+	uint64_t hash = lanes[0];
+	for (int lane = 1; lane < NUM_LANES; lane++)
+	{
+		hash = HashWord(hash, lanes[lane]);
+	}
+
+	return hash;
+}
+
+bool IsGameWorldValid(const GameWorld& world)
+{
+	const Game& game = world.game;
+	const Player& player = world.player;
+
+	if (game.windowSize.width <= 0 || game.windowSize.width > MAX_BOARD_SIZE ||
+		game.windowSize.height <= 0 || game.windowSize.height > MAX_BOARD_SIZE ||
+		game.currentState < GS_INTRO || game.currentState > GS_GAME_OVER ||
+		player.spriteSize.width != PLAYER_SPRITE_WIDTH || player.spriteSize.height != PLAYER_SPRITE_HEIGHT ||
+		player.animation < 0 || player.animation >= PLAYER_EXPLOSION_SPRITE.NUM_FRAMES ||
+		player.lives < 0 || player.lives > MAX_NUMBER_LIVES ||
+		!IsTimerWheelValid(game.timers) || !IsSwarmValid(world.aliens))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < MAX_GAME_TIMERS; i++)
+	{
+		const TimerEvent& event = game.timers.events[i];
+
+		if (event.type < GE_SWARM_STEP || event.type > GE_RESPAWN ||
+			(event.type == GE_EXPLOSION_END && (event.data < 0 || event.data >= AlienSwarm::Layout::NUM_ALIENS)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void InitGame(Game& game, const Size& boardSize, uint64_t seed)
+{
+	game.windowSize = boardSize;
+	InitTimerWheel(game.timers);
+	game.stats.frames = 0;
+	game.stats.bombsFired = 0;
+	game.stats.shieldCellsDestroyed = 0;
+	game.stats.playerHits = 0;
+	SeedRandom(game.random, seed);
+	game.level = 1;
+	game.currentState = GS_PLAY; // TODO: change to GS_INTRO when we're done
+}
+
+void InitPlayer(const Game& game, Player& player)
+{
+	player.lives = MAX_NUMBER_LIVES;
+	player.score = 0;
+	player.spriteSize.width = PLAYER_SPRITE_WIDTH;
+	player.spriteSize.height = PLAYER_SPRITE_HEIGHT;
+	ResetPlayer(game, player);
+}
+
+void ResetPlayer(const Game& game, Player& player)
+{
+	player.position.x = game.windowSize.width / 2 - player.spriteSize.width / 2;
+	player.position.y = game.windowSize.height - player.spriteSize.height - 1;
+
+	player.animation = 0;
+	ResetMissile(player);
+}
+
+void ResetMissile(Player& player)
+{
+	player.missile.x = NOT_IN_PLAY;
+	player.missile.y = NOT_IN_PLAY;
+}
+
+void HandleGameInput(Game& game, Player& player, int input)
+{
+	if (game.currentState == GS_PLAY)
+	{
+		if (input & GI_LEFT)
+		{
+			MovePlayer(game, player, -PLAYER_MOVEMENT_AMOUNT);
+		}
+
+		if (input & GI_RIGHT)
+		{
+			MovePlayer(game, player, PLAYER_MOVEMENT_AMOUNT);
+		}
+
+		if (input & GI_FIRE)
+		{
+			PlayerShoot(player);
+		}
+	}
+	else if (game.currentState == GS_PLAYER_DEAD && (input & GI_FIRE))
+	{
+		player.lives--;
+		player.animation = 0;
+		if (player.lives == 0)
+		{
+			game.currentState = GS_GAME_OVER;
+		}
+		else
+		{
+			game.currentState = GS_WAIT;
+			ScheduleTimer(game.timers, RESPAWN_WAIT_TIME, GE_RESPAWN, 0);
+		}
+	}
+}
+
+void UpdateGame(Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarm& aliens)
+{
+	PROFILE_SCOPE("UpdateGame");
+
+	game.stats.frames++;
+
+	// timers scheduled while this tick runs count from it, the ones due on it run at the end
+	AdvanceTimers(game.timers);
+
+	if (game.currentState == GS_PLAY)
+	{
+		UpdateMissile(player);
+		Position shieldCollidePoint;
+
+		int shieldIndex = IsCollision(player.missile, shields, numberOfShields, shieldCollidePoint);
+
+		if (shieldIndex != NOT_IN_PLAY)
+		{
+			ResetMissile(player);
+			ResolveShieldCollision(shields, shieldIndex, shieldCollidePoint);
+			game.stats.shieldCellsDestroyed++;
+		}
+
+		Position playerAlienCollidePoint;
+		if (IsCollision(player, aliens, playerAlienCollidePoint))
+		{
+			ResetMissile(player);
+			player.score += ResolveAlienCollision(aliens, playerAlienCollidePoint);
+
+			int alien = playerAlienCollidePoint.y * AlienSwarm::Layout::NUM_COLS + playerAlienCollidePoint.x;
+			if (!ScheduleTimer(game.timers, ALIENS_EXPLOSION_TIME, GE_EXPLOSION_END, alien))
+			{
+				SetAlienState(aliens, playerAlienCollidePoint.y, playerAlienCollidePoint.x, AS_DEAD); // no timer to spare, skip the explosion
+			}
+		}
+
+		if (UpdateBombs(game, aliens, player, shields, numberOfShields))
+		{
+			game.stats.playerHits++;
+		}
+	}
+	else if (game.currentState == GS_PLAYER_DEAD)
+	{
+		player.animation = (player.animation + 1) % 2;
+	}
+
+	RunGameEvents(game, shields, numberOfShields, aliens);
+}
+
+void RunGameEvents(Game& game, Shield shields[], int numberOfShields, AlienSwarm& aliens)
+{
+	PROFILE_SCOPE("RunGameEvents");
+
+	TimerEvent event;
+
+	while (NextDueTimer(game.timers, event))
+	{
+		switch (event.type)
+		{
+		case GE_SWARM_STEP:
+			if (game.currentState == GS_PLAY)
+			{
+				MoveSwarm(game, aliens, shields, numberOfShields);
+			}
+			else
+			{
+				ScheduleTimer(game.timers, 1, GE_SWARM_STEP, 0); // the swarm waits while the player is dead
+			}
+			break;
+
+		case GE_BOMB_VOLLEY:
+			if (game.currentState == GS_PLAY)
+			{
+				ShootBombVolley(game, aliens);
+			}
+
+			ScheduleTimer(game.timers, TicksUntilBombVolley(AlienSwarm::Layout::NUM_ALIENS, aliens.numAliensLeft, game.random), GE_BOMB_VOLLEY, 0);
+			break;
+
+		case GE_EXPLOSION_END:
+		{
+			int row = event.data / AlienSwarm::Layout::NUM_COLS;
+			int col = event.data % AlienSwarm::Layout::NUM_COLS;
+
+			if (GetAlienState(aliens, row, col) == AS_EXPLODING)
+			{
+				SetAlienState(aliens, row, col, AS_DEAD);
+			}
+			break;
+		}
+
+		case GE_RESPAWN:
+			if (game.currentState == GS_WAIT)
+			{
+				game.currentState = GS_PLAY;
+			}
+			break;
+		}
+	}
+}
+
+void MovePlayer(const Game& game, Player& player, int dx)
+{
+	if (player.position.x + player.spriteSize.width + dx > game.windowSize.width)
+	{
+		player.position.x = game.windowSize.width - player.spriteSize.width; // rightmost position
+	}
+	else if (player.position.x + dx < 0)
+	{
+		player.position.x = 0;
+	}
+	else
+	{
+		player.position.x += dx;
+	}
+}
+
+void PlayerShoot(Player& player)
+{
+	if (player.missile.x == NOT_IN_PLAY || player.missile.y == NOT_IN_PLAY)
+	{
+		player.missile.y = player.position.y - 1; //one row above the player
+		player.missile.x = player.position.x + player.spriteSize.width / 2;
+	}
+}
+
+void UpdateMissile(Player& player)
+{
+	if (player.missile.y != NOT_IN_PLAY)
+	{
+		player.missile.y -= PLAYER_MISSILE_SPEED;
+
+		if (player.missile.y < 0)
+		{
+			ResetMissile(player);
+		}
+	}
+}
+
+// one step of the swarm, across or, at the edge of the board, down and back the other way
+void MoveSwarm(Game& game, AlienSwarm& aliens, Shield shields[], int numberOfShields)
+{
+	int emptyColsLeft = 0;
+	int emptyColsRight = 0;
+	int emptyRowsBottom = 0;
+
+	FindEmptyRowsAndColumns(aliens, emptyColsLeft, emptyColsRight, emptyRowsBottom);
+
+	int numberOfColumns = AlienSwarm::Layout::NUM_COLS - emptyColsLeft - emptyColsRight;
+	int leftAlienPosition = aliens.position.x + emptyColsLeft * AlienSwarm::Layout::CELL_WIDTH;
+	int rightAlienPosition = leftAlienPosition + numberOfColumns * AlienSwarm::Layout::CELL_WIDTH - AlienSwarm::Layout::X_PADDING;
+
+	if (((rightAlienPosition >= game.windowSize.width && aliens.direction > 0) ||
+		(leftAlienPosition <= 0 && aliens.direction < 0)) && 
+		aliens.line > 0)
+	{
+		//move down position
+		aliens.position.y++;
+		aliens.line--;
+		aliens.direction = -aliens.direction;
+	}
+	else
+	{
+		aliens.position.x += aliens.direction;
+		aliens.animation = aliens.animation == 0 ? 1 : 0;
+	}
+
+	game.stats.shieldCellsDestroyed += DestroyShields(aliens, shields, numberOfShields);
+
+	ScheduleTimer(game.timers, SwarmStepDelay(aliens.line, AlienSwarm::Layout::NUM_ALIENS, aliens.numAliensLeft), GE_SWARM_STEP, 0);
+}
+
+void ShootBombVolley(Game& game, AlienSwarm& aliens)
+{
+	int numActiveCols = aliens.numberOfShooterColumns;
+
+	if (numActiveCols > 0)
+	{
+		int numberOfShots = (RandomInt(game.random, 3) + 1) - aliens.bombs.count;
+
+		for (int i = 0; i < numberOfShots; i++)
+		{
+			int columnToShoot = aliens.shooterColumns[RandomInt(game.random, numActiveCols)];
+			if (ShootBomb(aliens, columnToShoot))
+			{
+				game.stats.bombsFired++;
+			}
+		}
+	}
+}
+
+int SwarmStepDelay(int line, int numberOfAliens, int numAliensLeft)
+{
+	return line * 2 + (5 *
+		(float(numAliensLeft) / float(numberOfAliens)));
+}
+
+int CollideShieldsWithAlien(Shield shields[], int numberOfShields, int alienX, int alienY, const Bitmask alienRows[], const Size& size)
+{
+	int cellsDestroyed = 0;
+
+	for (int s = 0; s < numberOfShields; s++)
+	{
+		Shield& shield = shields[s];
+
+		if (alienX < shield.position.x + SHIELD_SPRITE_WIDTH && 
+			alienX + size.width >= shield.position.x &&
+			alienY < shield.position.y + SHIELD_SPRITE_HEIGHT &&
+			alienY + size.height >= shield.position.y)
+		{
+			// we are colliding, knock out the cells of each row under the alien's opaque cells
+
+			int dy = alienY - shield.position.y;
+			int dx = alienX - shield.position.x;
+
+			int firstY = std::max(dy, 0);
+			int lastY = std::min(dy + size.height, int(SHIELD_SPRITE_HEIGHT));
+
+			for (int shieldY = firstY; shieldY < lastY; shieldY++)
+			{
+				Bitmask alienRow = alienRows[shieldY - dy];
+				Bitmask covered = dx >= 0 ? alienRow << dx : alienRow >> -dx;
+
+				cellsDestroyed += CountSetBits(shield.rows[shieldY] & covered);
+				shield.rows[shieldY] &= ~covered;
+			}
+
+			break;
+
+		}
+	}
+
+	return cellsDestroyed;
+}
+
+void InitShields(const Game& game, Shield shields[], int numberOfShields)
+{
+	int firstPadding = ceil(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH)/float(numberOfShields+1));
+	int xPadding = floor(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH) / float(numberOfShields + 1));
+
+	for (int i = 0; i < numberOfShields; i++)
+	{
+		Shield& shield = shields[i];
+		shield.position.x = firstPadding + i * (SHIELD_SPRITE_WIDTH + xPadding);
+		shield.position.y = game.windowSize.height - PLAYER_SPRITE_HEIGHT - 1 - SHIELD_SPRITE_HEIGHT - 2;
+
+		for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+		{
+			shield.rows[row] = SHIELD_SPRITE.opaque[row];
+		}
+	}
+}
+
+// a volley has a small chance on every tick, more as the swarm thins out. The wait until the first tick that comes up
+// is geometric, so it is drawn once per volley instead of rolling the dice every tick
+int TicksUntilBombVolley(int numberOfAliens, int numAliensLeft, Random& random)
+{
+	// a swarm bigger than the classic one thins out further, but its volleys stop speeding up where the classic one's do
+	int thinning = std::min(int(float(numberOfAliens) / float(numAliensLeft + 1)), int(AlienSwarm::Layout::NUM_ALIENS));
+	double chance = 1.0 / (70 - thinning);
+	double uniform = (double(NextRandom(random)) + 1.0) / 4294967296.0; // (0, 1]
+
+	return 1 + int(std::log(uniform) / std::log1p(-chance));
+}
+
+bool UpdateBombs(Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields)
+{
+	PROFILE_SCOPE("UpdateBombs");
+
+	MoveProjectiles(aliens.bombs, ALIEN_BOMB_SPEED, ALIEN_BOMB_SPRITE.NUM_FRAMES);
+
+	bool playerHit = false;
+
+	// backwards, so removing a bomb only moves bombs we've already looked at
+	for (int i = aliens.bombs.count - 1; i >= 0; i--)
+	{
+		Position position = { aliens.bombs.x[i], aliens.bombs.y[i] };
+		Position collisionPoint;
+		int shieldIndex = IsCollision(position, shields, numberOfShields, collisionPoint);
+
+		if (shieldIndex != NOT_IN_PLAY)
+		{
+			RemoveProjectile(aliens.bombs, i);
+			ResolveShieldCollision(shields, shieldIndex, collisionPoint);
+			game.stats.shieldCellsDestroyed++;
+		}
+		else if (IsOpaque(PLAYER_SPRITE, 0, position.x - player.position.x, position.y - player.position.y))
+		{
+			RemoveProjectile(aliens.bombs, i);
+			playerHit = true;
+		}
+		else if (position.y >= game.windowSize.height)
+		{
+			RemoveProjectile(aliens.bombs, i);
+		}
+	}
+
+	return playerHit;
+}
+
+int IsCollision(const Position& projectile, const Shield shields[], int numberOfShields, Position& shieldCollidePoint)
+{
+	shieldCollidePoint.x = NOT_IN_PLAY;
+	shieldCollidePoint.y = NOT_IN_PLAY;
+
+	if (projectile.y != NOT_IN_PLAY)
+	{
+		for (int i = 0; i < numberOfShields; i++)
+		{
+			const Shield& shield = shields[i];
+
+			if (
+				// if the projectile is within the shield's x boundaries
+				projectile.x >= shield.position.x && projectile.x < (shield.position.x + SHIELD_SPRITE_WIDTH) &&
+				// and within the y boundaries
+				projectile.y >= shield.position.y && projectile.y < (shield.position.y + SHIELD_SPRITE_HEIGHT) &&
+				// and that part of the shield is still standing
+				(shield.rows[projectile.y - shield.position.y] >> (projectile.x - shield.position.x) & 1) != 0
+				)
+			{
+				// then there's a collision
+				shieldCollidePoint.x = projectile.x - shield.position.x;
+				shieldCollidePoint.y = projectile.y - shield.position.y;
+				return i;
+			}
+		}
+	}
+
+	return NOT_IN_PLAY;
+}
+
+bool IsCollision(const Position& projectile, const Position& spritePosition, const Size& spriteSize)
+{
+	return (projectile.x >= spritePosition.x && projectile.x < (spritePosition.x + spriteSize.width) &&
+		projectile.y >= spritePosition.y && projectile.y < (spritePosition.y + spriteSize.height));
+}
+
+void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollidePoint)
+{
+	shields[shieldIndex].rows[shieldCollidePoint.y] &= ~(Bitmask(1) << shieldCollidePoint.x);
+}
+
+int DestroyShields(const AlienSwarm& aliens, Shield shields[], int numberOfShields)
+{
+	int cellsDestroyed = 0;
+
+	const Size spriteSize = { AlienSwarm::Layout::SPRITE_WIDTH, AlienSwarm::Layout::SPRITE_HEIGHT };
+
+	for (int row = 0; row < AlienSwarm::Layout::NUM_ROWS; row++)
+	{
+		int y = AlienY(aliens, row);
+		const Bitmask* alienRows = FrameMask(AlienSpriteOfRow<AlienSwarm::Layout>(row), aliens.animation);
+
+		for (Bitmask alive = aliens.aliveInRow[row]; alive != 0; alive &= alive - 1)
+		{
+			cellsDestroyed += CollideShieldsWithAlien(shields, numberOfShields, AlienX(aliens, LowestSetBit(alive)), y, alienRows, spriteSize);
+		}
+	}
+
+	return cellsDestroyed;
+}
+
+void InitAliens(Game& game, AlienSwarm& aliens)
+{
+	typedef AlienSwarm::Layout Layout;
+
+	InitSwarm(aliens);
+
+	aliens.direction = 1; // going to the right
+	aliens.animation = 0;
+	aliens.position.x = (game.windowSize.width - Layout::NUM_COLS * Layout::CELL_WIDTH)/2;
+	aliens.position.y = game.windowSize.height - Layout::NUM_COLS - Layout::SWARM_HEIGHT - 3 + game.level;
+	aliens.line = Layout::NUM_COLS - (game.level - 1);
+
+	ScheduleTimer(game.timers, SwarmStepDelay(aliens.line, AlienSwarm::Layout::NUM_ALIENS, aliens.numAliensLeft), GE_SWARM_STEP, 0); // depends on line and numAliensLeft
+	ScheduleTimer(game.timers, TicksUntilBombVolley(AlienSwarm::Layout::NUM_ALIENS, aliens.numAliensLeft, game.random), GE_BOMB_VOLLEY, 0);
+}
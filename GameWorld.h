@@ -0,0 +1,77 @@
+#pragma once
+#include "TextInvaders.h"
+#include "AlienSwarm.h"
+#include <type_traits>
+
+// The game rules, with no dependency on curses or the terminal.
+// A GameWorld is stepped one tick at a time with the inputs for that tick,
+// so it can be driven by the curses front end, a bot or a batch simulation alike.
+// The whole state is one fixed size block with no pointers and no padding, so copying it is a memcpy
+// and two worlds in the same state are the same bytes.
+
+enum GameInput
+{
+	GI_NONE = 0,
+	GI_LEFT = 1 << 0,
+	GI_RIGHT = 1 << 1,
+	GI_FIRE = 1 << 2
+};
+
+// what the timers in Game::timers do when they come due
+enum GameEvent
+{
+	GE_SWARM_STEP = 0, // the swarm moves across, or down at the edge
+	GE_BOMB_VOLLEY, // the swarm drops up to three bombs
+	GE_EXPLOSION_END, // data is row * the number of columns + col of the alien that stops exploding
+	GE_RESPAWN // the wait after losing a life is over
+};
+
+struct GameWorld
+{
+	Game game;
+	Player player;
+	int unused; // always 0, fills what would otherwise be hidden padding
+	Shield shields[NUM_SHIELDS];
+	AlienSwarm aliens;
+};
+
+static_assert(std::is_trivially_copyable<GameWorld>::value, "a GameWorld has to be copyable with memcpy");
+static_assert(sizeof(Game) == sizeof(Size) + sizeof(GameState) + sizeof(int) + sizeof(TimerWheel<MAX_GAME_TIMERS>) + sizeof(Random) + sizeof(GameStats) &&
+	sizeof(GameWorld) == sizeof(Game) + sizeof(Player) + sizeof(int) + sizeof(Shield) * NUM_SHIELDS + sizeof(AlienSwarm) &&
+	sizeof(GameWorld) % sizeof(uint64_t) == 0, "HashGameWorld hashes every byte of a GameWorld, so it can't have padding in it");
+
+void InitGameWorld(GameWorld& world, const Size& boardSize, uint64_t seed);
+void StepGameWorld(GameWorld& world, int input); // input is a combination of GameInput flags
+uint64_t HashGameWorld(const GameWorld& world); // same hash means same game state, for checking replays and snapshots
+bool IsGameWorldValid(const GameWorld& world); // for a world read from outside, every count and index it is looked up with is in range
+
+void InitGame(Game& game, const Size& boardSize, uint64_t seed);
+
+void InitPlayer(const Game& game, Player& player);
+void InitShields(const Game& game, Shield shields[], int numberOfShields);
+void InitAliens(Game& game, AlienSwarm& aliens); // schedules the swarm's first step and volley
+
+void ResetPlayer(const Game& game, Player& player);
+void ResetMissile(Player& player);
+
+void HandleGameInput(Game& game, Player& player, int input);
+void UpdateGame(Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarm& aliens);
+
+void MovePlayer(const Game& game, Player& player, int dx);
+void PlayerShoot(Player& player);
+
+void UpdateMissile(Player& player);
+void RunGameEvents(Game& game, Shield shields[], int numberOfShields, AlienSwarm& aliens); // the timers due this tick
+void MoveSwarm(Game& game, AlienSwarm& aliens, Shield shields[], int numberOfShields);
+void ShootBombVolley(Game& game, AlienSwarm& aliens);
+int SwarmStepDelay(int line, int numberOfAliens, int numAliensLeft); // ticks between steps, the swarm speeds up as it comes down and thins out
+int TicksUntilBombVolley(int numberOfAliens, int numAliensLeft, Random& random);
+
+int IsCollision(const Position& projectile, const Shield shields[], int numberOfShields, Position& shieldCollidePoint);
+bool IsCollision(const Position& projectile, const Position& spritePosition, const Size& spriteSize);
+
+void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollidePoint);
+int DestroyShields(const AlienSwarm& aliens, Shield shields[], int numberOfShields);
+int CollideShieldsWithAlien(Shield shields[], int numberOfShields, int x, int y, const Bitmask alienRows[], const Size& spriteSize); // alienRows is the opaque mask of each row of the alien
+
+bool UpdateBombs(Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields);
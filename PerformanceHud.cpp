@@ -0,0 +1,81 @@
+#include "PerformanceHud.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+int Percentile(const int values[], int numberOfValues, int percent);
+
+void InitPerformanceHud(PerformanceHud& hud, int64_t nowMicroseconds)
+{
+	memset(&hud, 0, sizeof(hud));
+	hud.visible = false;
+	hud.windowStartMicroseconds = nowMicroseconds;
+}
+
+void RecordHudTicks(PerformanceHud& hud, int numberOfTicks, const GameWorld& world)
+{
+	int liveProjectiles = world.aliens.bombs.count + (world.player.missile.x != NOT_IN_PLAY ? 1 : 0);
+
+	hud.ticksInWindow += numberOfTicks;
+	hud.maxProjectilesInWindow = std::max(hud.maxProjectilesInWindow, liveProjectiles);
+}
+
+void RecordHudFrame(PerformanceHud& hud, int frameMicroseconds, int flushMicroseconds, int bytesSent, int64_t nowMicroseconds)
+{
+	hud.frameMicroseconds[hud.nextFrame] = frameMicroseconds;
+	hud.flushMicroseconds[hud.nextFrame] = flushMicroseconds;
+	hud.nextFrame = (hud.nextFrame + 1) % HUD_FRAME_HISTORY;
+	hud.numberOfFrames = std::min(hud.numberOfFrames + 1, int(HUD_FRAME_HISTORY));
+	hud.framesInWindow++;
+	hud.bytesInWindow += bytesSent;
+
+	int64_t windowMicroseconds = nowMicroseconds - hud.windowStartMicroseconds;
+
+	if (windowMicroseconds >= 1000000)
+	{
+		hud.tickRate = int(hud.ticksInWindow * 1000000LL / windowMicroseconds);
+		hud.frameRate = int(hud.framesInWindow * 1000000LL / windowMicroseconds);
+		hud.p99FrameMicroseconds = Percentile(hud.frameMicroseconds, hud.numberOfFrames, 99);
+		hud.p99FlushMicroseconds = Percentile(hud.flushMicroseconds, hud.numberOfFrames, 99);
+		hud.bytesPerFrame = int(hud.bytesInWindow / hud.framesInWindow);
+		hud.maxProjectiles = hud.maxProjectilesInWindow;
+
+		hud.windowStartMicroseconds = nowMicroseconds;
+		hud.ticksInWindow = 0;
+		hud.framesInWindow = 0;
+		hud.bytesInWindow = 0;
+		hud.maxProjectilesInWindow = 0;
+	}
+}
+
+int Percentile(const int values[], int numberOfValues, int percent)
+{
+	if (numberOfValues == 0)
+	{
+		return 0;
+	}
+
+	int sorted[HUD_FRAME_HISTORY];
+	std::copy(values, values + numberOfValues, sorted);
+
+	int* nth = sorted + (numberOfValues - 1) * percent / 100;
+	std::nth_element(sorted, nth, sorted + numberOfValues);
+
+	return *nth;
+}
+
+void DrawPerformanceHud(Renderer& renderer, const PerformanceHud& hud, const GameWorld& world)
+{
+	if (!hud.visible)
+	{
+		return;
+	}
+
+	// curses doesn't tell us what it sent, so with it the bytes are the renderer's estimate, marked with a ~
+	char line[128];
+	int length = snprintf(line, sizeof(line), " tick %d/s  draw %d/s  frame p99 %.2fms  flush p99 %.2fms  sent %s%dB/frame  projectiles %d  aliens %d ",
+		hud.tickRate, hud.frameRate, hud.p99FrameMicroseconds / 1000.0, hud.p99FlushMicroseconds / 1000.0,
+		renderer.bytesEstimated ? "~" : "", hud.bytesPerFrame, hud.maxProjectiles, world.aliens.numAliensLeft);
+
+	RenderString(renderer, 0, 0, line, std::min(length, int(sizeof(line)) - 1));
+}
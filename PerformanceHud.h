@@ -0,0 +1,41 @@
+#pragma once
+#include "GameWorld.h"
+#include "Renderer.h"
+#include <cstdint>
+
+// One line overlay in the top left corner with how fast the game is ticking and drawing,
+// for telling a slow terminal link (flush time and bytes go up, draw rate goes down) from a slow simulation (tick rate goes down).
+// It is drawn into the Renderer like everything else, so only the characters that change are sent.
+
+const int HUD_FRAME_HISTORY = 128; // p99 is over this many of the most recent frames
+
+struct PerformanceHud
+{
+	bool visible;
+
+	int frameMicroseconds[HUD_FRAME_HISTORY]; // draw + flush of each recent frame
+	int flushMicroseconds[HUD_FRAME_HISTORY]; // just the flush to the terminal
+	int numberOfFrames; // in the history, up to HUD_FRAME_HISTORY
+	int nextFrame;
+
+	int64_t windowStartMicroseconds; // the rates are counted over one second windows
+	int ticksInWindow;
+	int framesInWindow;
+	int64_t bytesInWindow;
+	int maxProjectilesInWindow;
+
+	// what is on display, recalculated once a second so the line doesn't flicker
+	int tickRate;
+	int frameRate;
+	int p99FrameMicroseconds;
+	int p99FlushMicroseconds;
+	int bytesPerFrame;
+	int maxProjectiles; // the most that were live at once
+};
+
+void InitPerformanceHud(PerformanceHud& hud, int64_t nowMicroseconds);
+
+void RecordHudTicks(PerformanceHud& hud, int numberOfTicks, const GameWorld& world); // world is where the ticks got to
+void RecordHudFrame(PerformanceHud& hud, int frameMicroseconds, int flushMicroseconds, int bytesSent, int64_t nowMicroseconds);
+
+void DrawPerformanceHud(Renderer& renderer, const PerformanceHud& hud, const GameWorld& world);
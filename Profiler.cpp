@@ -0,0 +1,171 @@
+#include "Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+
+using namespace std::chrono;
+
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t startNanoseconds;
+	uint32_t durationNanoseconds;
+	uint32_t threadId;
+};
+
+struct ProfileSlot
+{
+	// index + 1 of the event in this slot once it is completely written, 0 while it is being written.
+	// A reader copies the event out and checks this didn't change underneath it.
+	std::atomic<uint64_t> sequence;
+	ProfileEvent event;
+};
+
+struct Profiler
+{
+	ProfileSlot slots[PROFILE_BUFFER_SIZE];
+	std::atomic<uint64_t> nextEvent;
+	std::atomic<uint32_t> nextThreadId;
+};
+
+static_assert((PROFILE_BUFFER_SIZE & (PROFILE_BUFFER_SIZE - 1)) == 0, "PROFILE_BUFFER_SIZE must be a power of two");
+
+Profiler profiler; // zero initialized before anything can record into it
+thread_local int profilePauseDepth = 0;
+
+uint32_t ProfileThreadId();
+int CollectProfileEvents(std::vector<ProfileEvent>& events);
+
+uint64_t ProfileTimestamp()
+{
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t ProfileThreadId()
+{
+	thread_local uint32_t threadId = profiler.nextThreadId.fetch_add(1, std::memory_order_relaxed) + 1;
+	return threadId;
+}
+
+void RecordProfileEvent(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds)
+{
+	if (profilePauseDepth != 0)
+	{
+		return;
+	}
+
+	uint64_t index = profiler.nextEvent.fetch_add(1, std::memory_order_relaxed);
+	ProfileSlot& slot = profiler.slots[index & (PROFILE_BUFFER_SIZE - 1)];
+
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.event.name = name;
+	slot.event.startNanoseconds = startNanoseconds;
+	slot.event.durationNanoseconds = uint32_t(std::min<uint64_t>(endNanoseconds - startNanoseconds, UINT32_MAX));
+	slot.event.threadId = ProfileThreadId();
+
+	slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void ClearProfile()
+{
+	for (ProfileSlot& slot : profiler.slots)
+	{
+		slot.sequence.store(0, std::memory_order_relaxed);
+	}
+}
+
+// copies out every complete event still in the ring, oldest first, skipping any being overwritten as we read
+int CollectProfileEvents(std::vector<ProfileEvent>& events)
+{
+	uint64_t lastEvent = profiler.nextEvent.load(std::memory_order_acquire);
+	uint64_t firstEvent = lastEvent > PROFILE_BUFFER_SIZE ? lastEvent - PROFILE_BUFFER_SIZE : 0;
+
+	events.clear();
+	events.reserve(size_t(lastEvent - firstEvent));
+
+	for (uint64_t index = firstEvent; index < lastEvent; index++)
+	{
+		const ProfileSlot& slot = profiler.slots[index & (PROFILE_BUFFER_SIZE - 1)];
+
+		uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence != index + 1)
+		{
+			continue;
+		}
+
+		ProfileEvent event = slot.event;
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+		{
+			events.push_back(event);
+		}
+	}
+
+	return int(events.size());
+}
+
+bool WriteChromeTrace(const char* fileName)
+{
+	std::vector<ProfileEvent> events;
+	CollectProfileEvents(events);
+
+	FILE* file = fopen(fileName, "w");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	uint64_t startTime = events.empty() ? 0 : events.front().startNanoseconds;
+	for (const ProfileEvent& event : events)
+	{
+		startTime = std::min(startTime, event.startNanoseconds);
+	}
+
+	// complete events ("ph": "X") with microsecond times, one per line
+	fprintf(file, "{\"traceEvents\": [\n");
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		const ProfileEvent& event = events[i];
+
+		fprintf(file, "  {\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %u}%s\n",
+			event.name, (event.startNanoseconds - startTime) / 1000.0, event.durationNanoseconds / 1000.0,
+			event.threadId, i + 1 < events.size() ? "," : "");
+	}
+
+	fprintf(file, "], \"displayTimeUnit\": \"ns\"}\n");
+
+	return fclose(file) == 0;
+}
+
+void WriteProfileSummary(FILE* file)
+{
+	std::vector<ProfileEvent> events;
+	CollectProfileEvents(events);
+
+	std::map<std::string, std::vector<uint32_t>> durations;
+	for (const ProfileEvent& event : events)
+	{
+		durations[event.name].push_back(event.durationNanoseconds);
+	}
+
+	fprintf(file, "%-20s %10s %12s %12s %12s\n", "scope", "count", "p50 us", "p99 us", "max us");
+
+	for (auto& scope : durations)
+	{
+		std::vector<uint32_t>& times = scope.second;
+		std::sort(times.begin(), times.end());
+
+		uint32_t p50 = times[(times.size() - 1) * 50 / 100];
+		uint32_t p99 = times[(times.size() - 1) * 99 / 100];
+
+		fprintf(file, "%-20s %10zu %12.2f %12.2f %12.2f\n", scope.first.c_str(), times.size(),
+			p50 / 1000.0, p99 / 1000.0, times.back() / 1000.0);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+// Scoped timers for finding out where a frame's time goes. Build with TEXTINVADERS_PROFILE defined
+// (and Profiler.cpp linked in) to turn them on, without it PROFILE_SCOPE compiles to nothing.
+//
+//	void UpdateGame(...)
+//	{
+//		PROFILE_SCOPE("UpdateGame");
+//		...
+//
+// Every scope that ends records one event into a fixed size ring buffer, the oldest events are overwritten.
+// Recording never locks or allocates, so it is safe from any thread. PROFILE_PAUSE stops the thread it is on recording
+// until the end of its scope, for code that runs the timed code many times over on copies, like the autopilot's rollouts,
+// which would otherwise fill the ring with their own events.
+
+const int PROFILE_BUFFER_SIZE = 1 << 16; // events kept, must be a power of two
+
+uint64_t ProfileTimestamp(); // nanoseconds on a steady clock
+void RecordProfileEvent(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds); // name must be a string literal
+void ClearProfile();
+
+extern thread_local int profilePauseDepth; // nothing is recorded on this thread while it isn't 0
+
+bool WriteChromeTrace(const char* fileName); // load it in chrome://tracing or ui.perfetto.dev
+void WriteProfileSummary(FILE* file); // count, p50, p99 and max for every scope name
+
+struct ProfileScope
+{
+	const char* name;
+	uint64_t startNanoseconds;
+
+	explicit ProfileScope(const char* scopeName) : name(scopeName), startNanoseconds(profilePauseDepth == 0 ? ProfileTimestamp() : 0) {}
+	~ProfileScope()
+	{
+		if (profilePauseDepth == 0)
+		{
+			RecordProfileEvent(name, startNanoseconds, ProfileTimestamp());
+		}
+	}
+};
+
+struct ProfilePause
+{
+	ProfilePause() { profilePauseDepth++; }
+	~ProfilePause() { profilePauseDepth--; }
+};
+
+#ifdef TEXTINVADERS_PROFILE
+#define PROFILE_CONCATENATE_(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCATENATE(profileScope, __LINE__)(name)
+#define PROFILE_PAUSE() ProfilePause PROFILE_CONCATENATE(profilePause, __LINE__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_PAUSE()
+#endif
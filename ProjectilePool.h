@@ -0,0 +1,89 @@
+#pragma once
+
+// Fixed capacity pool of projectiles laid out as a structure of arrays.
+// Live projectiles are packed into [0, count) so updates are flat loops the compiler can vectorize,
+// removing one moves the last one into its place, so a projectile's index is only good until the next removal.
+template<int CAPACITY>
+struct ProjectilePool
+{
+	int count;
+	int x[CAPACITY];
+	int y[CAPACITY];
+	int animation[CAPACITY];
+};
+
+template<int CAPACITY>
+void InitProjectiles(ProjectilePool<CAPACITY>& pool)
+{
+	pool.count = 0;
+}
+
+// returns false if the pool is full
+template<int CAPACITY>
+bool SpawnProjectile(ProjectilePool<CAPACITY>& pool, int xPos, int yPos)
+{
+	if (pool.count == CAPACITY)
+	{
+		return false;
+	}
+
+	int index = pool.count++;
+
+	pool.x[index] = xPos;
+	pool.y[index] = yPos;
+	pool.animation[index] = 0;
+
+	return true;
+}
+
+// removes the projectile at index by moving the last one into its place,
+// so when removing while iterating, iterate from the back
+template<int CAPACITY>
+void RemoveProjectile(ProjectilePool<CAPACITY>& pool, int index)
+{
+	int last = --pool.count;
+
+	pool.x[index] = pool.x[last];
+	pool.y[index] = pool.y[last];
+	pool.animation[index] = pool.animation[last];
+}
+
+// moves every projectile dy rows and steps its animation
+template<int CAPACITY>
+void MoveProjectiles(ProjectilePool<CAPACITY>& pool, int dy, int numberOfAnimationFrames)
+{
+	const int count = pool.count;
+	int* y = pool.y;
+	int* animation = pool.animation;
+
+	for (int i = 0; i < count; i++)
+	{
+		y[i] += dy;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		int next = animation[i] + 1;
+		animation[i] = next == numberOfAnimationFrames ? 0 : next;
+	}
+}
+
+// for a pool read from outside: the count and every animation frame are in range
+template<int CAPACITY>
+bool IsProjectilePoolValid(const ProjectilePool<CAPACITY>& pool, int numberOfAnimationFrames)
+{
+	if (pool.count < 0 || pool.count > CAPACITY)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < pool.count; i++)
+	{
+		if (pool.animation[i] < 0 || pool.animation[i] >= numberOfAnimationFrames)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+// PCG32 (pcg-random.org): 64 bits of state, 32 bit outputs. Every game owns one and seeds it explicitly,
+// so the same seed and inputs replay the same game and games on different threads don't share any state.
+struct Random
+{
+	uint64_t state;
+	uint64_t increment; // must be odd, picks one of 2^63 independent streams
+};
+
+inline uint32_t NextRandom(Random& random)
+{
+	uint64_t oldState = random.state;
+	random.state = oldState * 6364136223846793005ULL + random.increment;
+
+	uint32_t xorShifted = uint32_t(((oldState >> 18) ^ oldState) >> 27);
+	uint32_t rotation = uint32_t(oldState >> 59);
+
+	return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+inline void SeedRandom(Random& random, uint64_t seed, uint64_t stream = 0)
+{
+	random.state = 0;
+	random.increment = (stream << 1) | 1;
+	NextRandom(random);
+	random.state += seed;
+	NextRandom(random);
+}
+
+// uniform-ish integer in [0, bound), bound must be > 0
+inline int RandomInt(Random& random, int bound)
+{
+	return int((uint64_t(NextRandom(random)) * uint32_t(bound)) >> 32);
+}
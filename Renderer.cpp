@@ -0,0 +1,44 @@
+#include "Renderer.h"
+#include <cstring>
+#include <algorithm>
+
+void InitRenderer(Renderer& renderer, int width, int height, bool presents)
+{
+	renderer.width = width;
+	renderer.height = height;
+	renderer.frontBuffer.assign(presents ? width * height : 0, ' '); // initscr starts with a blank screen
+	renderer.backBuffer.assign(width * height, ' ');
+	renderer.bytesLastFrame = 0;
+	renderer.bytesEstimated = true;
+	renderer.cellsLastFrame = 0;
+}
+
+void BeginFrame(Renderer& renderer)
+{
+	std::fill(renderer.backBuffer.begin(), renderer.backBuffer.end(), ' ');
+}
+
+void RenderCharacter(Renderer& renderer, int xPos, int yPos, char aCharacter)
+{
+	if (xPos >= 0 && xPos < renderer.width && yPos >= 0 && yPos < renderer.height)
+	{
+		renderer.backBuffer[yPos * renderer.width + xPos] = aCharacter;
+	}
+}
+
+void RenderString(Renderer& renderer, int xPos, int yPos, const char* aString, int length)
+{
+	if (yPos < 0 || yPos >= renderer.height)
+	{
+		return;
+	}
+
+	// clip the string to the screen
+	int first = xPos < 0 ? -xPos : 0;
+	int last = xPos + length > renderer.width ? renderer.width - xPos : length;
+
+	if (first < last)
+	{
+		memcpy(&renderer.backBuffer[yPos * renderer.width + xPos + first], aString + first, last - first);
+	}
+}
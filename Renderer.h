@@ -0,0 +1,39 @@
+#pragma once
+#include "Sprite.h"
+#include <vector>
+
+// Cell buffer renderer on top of CursesUtils. The game draws a whole frame into the back buffer,
+// PresentFrame then compares it against what is already on the terminal and only sends the cells that changed.
+// PresentFrame lives in RendererPresent.cpp with the curses calls, the rest needs no terminal.
+struct Renderer
+{
+	int width;
+	int height;
+	std::vector<char> frontBuffer; // what the terminal is showing right now, empty if the renderer is never presented
+	std::vector<char> backBuffer; // the frame being drawn
+	int bytesLastFrame; // bytes sent to the terminal by the last PresentFrame
+	bool bytesEstimated; // curses doesn't say what it sent, so with it bytesLastFrame is our estimate of what it had to
+	int cellsLastFrame; // cells that changed in the last PresentFrame
+};
+
+// a renderer whose frames go somewhere other than PresentFrame, like the server's, can leave out the front buffer
+void InitRenderer(Renderer& renderer, int width, int height, bool presents = true);
+
+void BeginFrame(Renderer& renderer);
+int PresentFrame(Renderer& renderer);
+
+void RenderCharacter(Renderer& renderer, int xPos, int yPos, char aCharacter);
+void RenderString(Renderer& renderer, int xPos, int yPos, const char* aString, int length);
+
+// copies each row's run from its first opaque cell to its last, so a sprite's blank edges don't rub out what's behind it
+template<int WIDTH, int HEIGHT, int FRAMES>
+void RenderSprite(Renderer& renderer, int xPos, int yPos, const Sprite<WIDTH, HEIGHT, FRAMES>& sprite, int frame = 0)
+{
+	for (int h = 0; h < HEIGHT; h++)
+	{
+		int row = frame * HEIGHT + h;
+		int start = sprite.runStart[row];
+
+		RenderString(renderer, xPos + start, yPos + h, sprite.cells[row] + start, sprite.runLength[row]);
+	}
+}
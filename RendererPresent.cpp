@@ -0,0 +1,87 @@
+#include "Renderer.h"
+#include "CursesUtils.h"
+#include "Profiler.h"
+#include <cstring>
+
+// the half of the renderer that talks to the terminal, kept apart so the server can draw frames without curses
+
+int CursorMoveCost(int xPos, int yPos);
+
+int PresentFrame(Renderer& renderer)
+{
+	PROFILE_SCOPE("PresentFrame");
+
+	int bytes = 0;
+	int cells = 0;
+
+	for (int y = 0; y < renderer.height; y++)
+	{
+		char* front = &renderer.frontBuffer[y * renderer.width];
+		const char* back = &renderer.backBuffer[y * renderer.width];
+
+		int x = 0;
+		while (x < renderer.width)
+		{
+			if (front[x] == back[x])
+			{
+				x++;
+				continue;
+			}
+
+			// extend the run over unchanged gaps that are cheaper to resend than to jump over
+			int runStart = x;
+			int runEnd = x + 1;
+			int gapCost = CursorMoveCost(runStart, y);
+
+			for (int next = runEnd; next < renderer.width && next - runEnd <= gapCost; next++)
+			{
+				if (front[next] != back[next])
+				{
+					runEnd = next + 1;
+				}
+			}
+
+			for (int i = runStart; i < runEnd; i++)
+			{
+				cells += front[i] != back[i];
+			}
+
+			DrawString(runStart, y, back + runStart, runEnd - runStart);
+			memcpy(front + runStart, back + runStart, runEnd - runStart);
+
+			bytes += CursorMoveCost(runStart, y) + (runEnd - runStart);
+			x = runEnd;
+		}
+	}
+
+	int bytesWritten;
+
+	{
+		PROFILE_SCOPE("RefreshScreen"); // the curses flush, usually the most expensive part of a frame
+		bytesWritten = RefreshScreen();
+	}
+
+	renderer.bytesEstimated = bytesWritten < 0;
+	renderer.bytesLastFrame = renderer.bytesEstimated ? bytes : bytesWritten;
+	renderer.cellsLastFrame = cells;
+
+	return renderer.bytesLastFrame;
+}
+
+// length of the "ESC [ row ; col H" sequence the terminal needs to put the cursor at (xPos, yPos)
+int CursorMoveCost(int xPos, int yPos)
+{
+	int cost = 4;
+
+	for (int n = xPos + 1; n > 0; n /= 10)
+	{
+		cost++;
+	}
+
+	for (int n = yPos + 1; n > 0; n /= 10)
+	{
+		cost++;
+	}
+
+	return cost;
+}
@@ -0,0 +1,204 @@
+#include "Replay.h"
+#include <cstdio>
+#include <cstring>
+#include <climits>
+
+const char REPLAY_MAGIC[4] = { 'T', 'I', 'R', 'P' };
+
+enum
+{
+	REPLAY_VERSION = 6, // 2 hashes the whole GameWorld, 3 dropped the swarm's sprite size from it, 4 hits only count on opaque cells, 5 added the timer wheel, 6 dropped the bomb pool's handles
+	INPUT_BITS = 3,
+	INPUT_MASK = (1 << INPUT_BITS) - 1
+};
+
+void FlushRun(Replay& replay);
+void WriteVarint(std::vector<unsigned char>& bytes, uint64_t value);
+bool ReadVarint(const unsigned char*& bytes, const unsigned char* end, uint64_t& value);
+
+void StartRecording(Replay& replay, uint64_t seed, const Size& boardSize)
+{
+	replay.seed = seed;
+	replay.boardSize = boardSize;
+	replay.numberOfTicks = 0;
+	replay.runs.clear();
+	replay.currentInput = GI_NONE;
+	replay.currentRunLength = 0;
+	replay.finalScore = 0;
+	replay.finalHash = 0;
+}
+
+void RecordTick(Replay& replay, int input)
+{
+	if (input != replay.currentInput && replay.currentRunLength > 0)
+	{
+		FlushRun(replay);
+	}
+
+	replay.currentInput = input;
+	replay.currentRunLength++;
+	replay.numberOfTicks++;
+}
+
+void FinishRecording(Replay& replay, const GameWorld& world)
+{
+	if (replay.currentRunLength > 0)
+	{
+		FlushRun(replay);
+	}
+
+	replay.finalScore = world.player.score;
+	replay.finalHash = HashGameWorld(world);
+}
+
+void FlushRun(Replay& replay)
+{
+	WriteVarint(replay.runs, (uint64_t(replay.currentRunLength - 1) << INPUT_BITS) | (replay.currentInput & INPUT_MASK));
+	replay.currentRunLength = 0;
+}
+
+bool SaveReplay(const Replay& replay, const char* fileName)
+{
+	std::vector<unsigned char> bytes(REPLAY_MAGIC, REPLAY_MAGIC + sizeof(REPLAY_MAGIC));
+
+	WriteVarint(bytes, REPLAY_VERSION);
+	WriteVarint(bytes, replay.seed);
+	WriteVarint(bytes, replay.boardSize.width);
+	WriteVarint(bytes, replay.boardSize.height);
+	WriteVarint(bytes, replay.numberOfTicks);
+	WriteVarint(bytes, replay.finalScore);
+	WriteVarint(bytes, replay.finalHash);
+	WriteVarint(bytes, replay.runs.size());
+	bytes.insert(bytes.end(), replay.runs.begin(), replay.runs.end());
+
+	FILE* file = fopen(fileName, "wb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	return fclose(file) == 0 && written;
+}
+
+bool LoadReplay(Replay& replay, const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> bytes;
+	unsigned char buffer[4096];
+	size_t numberRead;
+
+	while ((numberRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		bytes.insert(bytes.end(), buffer, buffer + numberRead);
+	}
+
+	fclose(file);
+
+	if (bytes.size() < sizeof(REPLAY_MAGIC) || memcmp(bytes.data(), REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0)
+	{
+		return false;
+	}
+
+	const unsigned char* position = bytes.data() + sizeof(REPLAY_MAGIC);
+	const unsigned char* end = bytes.data() + bytes.size();
+	uint64_t version, seed, width, height, numberOfTicks, finalScore, finalHash, runsSize;
+
+	if (!ReadVarint(position, end, version) || version != REPLAY_VERSION ||
+		!ReadVarint(position, end, seed) ||
+		!ReadVarint(position, end, width) || width == 0 || width > MAX_BOARD_SIZE ||
+		!ReadVarint(position, end, height) || height == 0 || height > MAX_BOARD_SIZE ||
+		!ReadVarint(position, end, numberOfTicks) || numberOfTicks > uint64_t(INT_MAX) ||
+		!ReadVarint(position, end, finalScore) ||
+		!ReadVarint(position, end, finalHash) ||
+		!ReadVarint(position, end, runsSize) ||
+		runsSize != uint64_t(end - position))
+	{
+		return false;
+	}
+
+	replay.seed = seed;
+	replay.boardSize.width = int(width);
+	replay.boardSize.height = int(height);
+	replay.numberOfTicks = int(numberOfTicks);
+	replay.finalScore = int(finalScore);
+	replay.finalHash = finalHash;
+	replay.runs.assign(position, end);
+	replay.currentInput = GI_NONE;
+	replay.currentRunLength = 0;
+
+	return true;
+}
+
+bool PlayReplay(const Replay& replay, GameWorld& world)
+{
+	InitGameWorld(world, replay.boardSize, replay.seed);
+
+	const unsigned char* position = replay.runs.data();
+	const unsigned char* end = position + replay.runs.size();
+	int numberOfTicks = 0;
+	uint64_t run;
+
+	while (position < end)
+	{
+		if (!ReadVarint(position, end, run))
+		{
+			return false;
+		}
+
+		int input = int(run & INPUT_MASK);
+		uint64_t runLength = (run >> INPUT_BITS) + 1;
+
+		// a corrupt run could otherwise keep us stepping for centuries
+		if (runLength > uint64_t(replay.numberOfTicks - numberOfTicks))
+		{
+			return false;
+		}
+
+		for (uint64_t i = 0; i < runLength; i++)
+		{
+			StepGameWorld(world, input);
+		}
+
+		numberOfTicks += int(runLength);
+	}
+
+	return numberOfTicks == replay.numberOfTicks &&
+		world.player.score == replay.finalScore &&
+		HashGameWorld(world) == replay.finalHash;
+}
+
+// LEB128: 7 bits per byte, high bit set on every byte but the last
+void WriteVarint(std::vector<unsigned char>& bytes, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+
+	bytes.push_back((unsigned char)value);
+}
+
+bool ReadVarint(const unsigned char*& bytes, const unsigned char* end, uint64_t& value)
+{
+	value = 0;
+
+	for (int shift = 0; shift < 64 && bytes < end; shift += 7)
+	{
+		unsigned char byte = *bytes++;
+		value |= uint64_t(byte & 0x7f) << shift;
+
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
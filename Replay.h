@@ -0,0 +1,29 @@
+#pragma once
+#include "GameWorld.h"
+#include <vector>
+
+// A recorded game: the seed and board size it started from and the input of every tick.
+// Ticks are stored as runs of identical input, each run is one varint holding (length - 1) << 3 | input,
+// so a tick nobody touches the keyboard in costs nothing and a key press usually costs a byte or two.
+// The final score and state hash let the player check the replay reproduced the game exactly.
+struct Replay
+{
+	uint64_t seed;
+	Size boardSize;
+	int numberOfTicks;
+	std::vector<unsigned char> runs;
+	int currentInput; // the run being recorded
+	int currentRunLength;
+	int finalScore;
+	uint64_t finalHash;
+};
+
+void StartRecording(Replay& replay, uint64_t seed, const Size& boardSize);
+void RecordTick(Replay& replay, int input);
+void FinishRecording(Replay& replay, const GameWorld& world);
+
+bool SaveReplay(const Replay& replay, const char* fileName);
+bool LoadReplay(Replay& replay, const char* fileName);
+
+// steps a fresh world through every recorded tick as fast as possible, returns true if it ends up where the recording did
+bool PlayReplay(const Replay& replay, GameWorld& world);
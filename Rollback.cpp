@@ -0,0 +1,149 @@
+#include "Rollback.h"
+#include <algorithm>
+#include <cstring>
+
+void RunTick(RollbackSession& session, int tick);
+void UpdateSyncHashes(RollbackSession& session);
+
+void InitRollback(RollbackSession& session, const VersusState& start, int localPlayer)
+{
+	memset(&session, 0, sizeof(session));
+	memcpy(&session.state, &start, sizeof(start));
+
+	session.localPlayer = localPlayer;
+	session.remotePlayer = (localPlayer + 1) % VERSUS_PLAYERS;
+	session.rollbackTick = NOT_IN_PLAY;
+	session.syncTick = NOT_IN_PLAY;
+	session.desynced = false;
+}
+
+bool CanAdvance(const RollbackSession& session)
+{
+	// the second limit keeps the local inputs the remote player hasn't got yet inside the window, so they can be resent
+	return session.currentTick - session.confirmedTick < MAX_PREDICTION_TICKS &&
+		session.currentTick - session.remoteAckTick < MAX_PREDICTION_TICKS;
+}
+
+// both sides see the other a one way trip late, comparing the two advantages cancels the trip out
+int TicksAhead(const RollbackSession& session)
+{
+	return (LocalAdvantage(session) - session.remoteAdvantage) / 2;
+}
+
+int LocalAdvantage(const RollbackSession& session)
+{
+	return session.currentTick - session.remoteTick;
+}
+
+int AdvanceRollback(RollbackSession& session, int localInput)
+{
+	int ticksRun = 0;
+
+	if (session.rollbackTick != NOT_IN_PLAY)
+	{
+		int rollbackLength = session.currentTick - session.rollbackTick;
+
+		memcpy(&session.state, &session.snapshots[session.rollbackTick % ROLLBACK_WINDOW], sizeof(session.state));
+
+		for (int tick = session.rollbackTick; tick < session.currentTick; tick++)
+		{
+			RunTick(session, tick);
+		}
+
+		session.rollbacks++;
+		session.ticksResimulated += rollbackLength;
+		session.longestRollback = std::max(session.longestRollback, rollbackLength);
+		session.rollbackTick = NOT_IN_PLAY;
+		ticksRun += rollbackLength;
+	}
+
+	UpdateSyncHashes(session);
+
+	session.inputs[session.localPlayer][session.currentTick % ROLLBACK_WINDOW] = localInput;
+	RunTick(session, session.currentTick);
+	session.currentTick++;
+
+	return ticksRun + 1;
+}
+
+// saves the state before the tick so it can be rolled back to, then runs it
+void RunTick(RollbackSession& session, int tick)
+{
+	int slot = tick % ROLLBACK_WINDOW;
+
+	memcpy(&session.snapshots[slot], &session.state, sizeof(session.state));
+
+	// guess the remote player is still pressing what they last pressed
+	if (tick >= session.confirmedTick)
+	{
+		session.inputs[session.remotePlayer][slot] = session.confirmedTick > 0 ?
+			session.inputs[session.remotePlayer][(session.confirmedTick - 1) % ROLLBACK_WINDOW] : int(GI_NONE);
+	}
+
+	int inputs[VERSUS_PLAYERS];
+	for (int player = 0; player < VERSUS_PLAYERS; player++)
+	{
+		inputs[player] = session.inputs[player][slot];
+	}
+
+	StepVersus(session.state, inputs);
+}
+
+// every state up to the first one with a guess in its past is final, hash the ones we haven't yet
+void UpdateSyncHashes(RollbackSession& session)
+{
+	int lastConfirmedTick = std::min(session.confirmedTick, session.currentTick);
+
+	for (int tick = std::max(session.syncTick + 1, session.currentTick - ROLLBACK_WINDOW + 1); tick <= lastConfirmedTick; tick++)
+	{
+		const VersusState& state = tick == session.currentTick ? session.state : session.snapshots[tick % ROLLBACK_WINDOW];
+		session.syncHashes[tick % ROLLBACK_WINDOW] = HashVersus(state);
+		session.syncTick = tick;
+	}
+}
+
+void AddRemoteInput(RollbackSession& session, int tick, int input)
+{
+	// anything but the next input we're missing is a repeat, or past a gap a later packet will fill,
+	// or too far ahead to fit in the window, which the remote player's own CanAdvance should rule out
+	if (tick != session.confirmedTick || tick >= session.currentTick + ROLLBACK_WINDOW - MAX_PREDICTION_TICKS)
+	{
+		return;
+	}
+
+	int slot = tick % ROLLBACK_WINDOW;
+
+	if (tick < session.currentTick && session.inputs[session.remotePlayer][slot] != input)
+	{
+		session.rollbackTick = session.rollbackTick == NOT_IN_PLAY ? tick : std::min(session.rollbackTick, tick);
+	}
+
+	session.inputs[session.remotePlayer][slot] = input;
+	session.confirmedTick++;
+}
+
+void AddRemoteStatus(RollbackSession& session, int remoteTick, int ackTick, int advantage)
+{
+	// packets can arrive out of order, only newer news counts
+	if (remoteTick >= session.remoteTick)
+	{
+		session.remoteTick = remoteTick;
+		session.remoteAdvantage = advantage;
+	}
+
+	session.remoteAckTick = std::max(session.remoteAckTick, std::min(ackTick, session.currentTick));
+}
+
+void CheckRemoteHash(RollbackSession& session, int tick, uint64_t hash)
+{
+	if (tick >= 0 && tick <= session.syncTick && tick > session.syncTick - ROLLBACK_WINDOW &&
+		session.syncHashes[tick % ROLLBACK_WINDOW] != hash)
+	{
+		session.desynced = true;
+	}
+}
+
+int GetLocalInput(const RollbackSession& session, int tick)
+{
+	return session.inputs[session.localPlayer][tick % ROLLBACK_WINDOW];
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Versus.h"
+
+// GGPO style rollback for a versus match between two machines. Every tick runs straight away with the local
+// player's input and a guess for the remote player's, the last input that arrived from them. When the real input
+// turns up and the guess was wrong, the state goes back to the snapshot from before that tick and every tick since
+// is run again, all before the next frame is drawn, so the local player never waits on the network.
+// Moving inputs between the machines is up to the caller.
+
+enum
+{
+	ROLLBACK_WINDOW = 32, // ticks of snapshots and inputs kept
+	MAX_PREDICTION_TICKS = 12 // wait for the remote player rather than guess further ahead than this
+};
+
+struct RollbackSession
+{
+	int localPlayer;
+	int remotePlayer;
+	VersusState state; // at the start of currentTick, built on guesses for remote inputs from confirmedTick on
+	VersusState snapshots[ROLLBACK_WINDOW]; // the state at the start of tick t is in t % ROLLBACK_WINDOW
+	int inputs[VERSUS_PLAYERS][ROLLBACK_WINDOW]; // the input used for tick t, a guess for the remote player from confirmedTick on
+	int currentTick; // the next tick to run
+	int confirmedTick; // every remote input before this has arrived
+	int rollbackTick; // the earliest tick that was run with a wrong guess, NOT_IN_PLAY if none
+
+	// what the remote player last told us about themselves
+	int remoteTick; // the next tick they were going to run
+	int remoteAckTick; // they have every local input before this
+	int remoteAdvantage; // how far they were ahead of the ticks they had seen from us
+
+	// hashes of confirmed states, compared with the remote player's to catch the two games drifting apart
+	uint64_t syncHashes[ROLLBACK_WINDOW]; // the hash of the confirmed state at the start of tick t is in t % ROLLBACK_WINDOW
+	int syncTick; // the newest tick with a hash
+	bool desynced;
+
+	// running totals for the status line
+	int rollbacks;
+	int ticksResimulated;
+	int longestRollback;
+};
+
+void InitRollback(RollbackSession& session, const VersusState& start, int localPlayer);
+
+bool CanAdvance(const RollbackSession& session); // false when we're too far ahead of the remote player and have to wait
+int TicksAhead(const RollbackSession& session); // how many ticks we're ahead of the remote player, skip one now and then if it's above 0
+int AdvanceRollback(RollbackSession& session, int localInput); // returns the number of ticks run, re-run ones included
+
+void AddRemoteInput(RollbackSession& session, int tick, int input); // inputs can arrive more than once, repeats are ignored
+void AddRemoteStatus(RollbackSession& session, int remoteTick, int ackTick, int advantage);
+void CheckRemoteHash(RollbackSession& session, int tick, uint64_t hash);
+
+int GetLocalInput(const RollbackSession& session, int tick); // tick must be in [remoteAckTick, currentTick)
+int LocalAdvantage(const RollbackSession& session); // to send to the remote player
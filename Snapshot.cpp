@@ -0,0 +1,144 @@
+#include "Snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+
+const char SAVE_MAGIC[4] = { 'T', 'I', 'S', 'V' };
+
+enum
+{
+	SAVE_VERSION = 2 // 2 added the layout fingerprint, bump it whenever a GameWorld's layout changes
+};
+
+// written as is, in the machine's own byte order
+struct SaveHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t worldSize;
+	uint32_t layout; // SaveLayoutFingerprint() of the build that wrote it
+	uint64_t hash; // of the world that follows, to catch a truncated or damaged file
+};
+
+uint32_t SaveLayoutFingerprint();
+
+void InitSnapshotStack(SnapshotStack& stack, int capacity)
+{
+	stack.snapshots.resize(capacity);
+	stack.count = 0;
+}
+
+bool PushSnapshot(SnapshotStack& stack, const GameWorld& world)
+{
+	if (stack.count == int(stack.snapshots.size()))
+	{
+		return false;
+	}
+
+	memcpy(&stack.snapshots[stack.count++], &world, sizeof(world));
+	return true;
+}
+
+bool PopSnapshot(SnapshotStack& stack, GameWorld& world)
+{
+	if (stack.count == 0)
+	{
+		return false;
+	}
+
+	memcpy(&world, &stack.snapshots[--stack.count], sizeof(world));
+	return true;
+}
+
+const GameWorld* PeekSnapshot(const SnapshotStack& stack, int depth)
+{
+	if (depth < 0 || depth >= stack.count)
+	{
+		return NULL;
+	}
+
+	return &stack.snapshots[stack.count - 1 - depth];
+}
+
+void TruncateSnapshots(SnapshotStack& stack, int count)
+{
+	if (count < stack.count)
+	{
+		stack.count = count < 0 ? 0 : count;
+	}
+}
+
+bool SaveGameWorld(const GameWorld& world, const char* fileName)
+{
+	SaveHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+	header.version = SAVE_VERSION;
+	header.worldSize = sizeof(world);
+	header.layout = SaveLayoutFingerprint();
+	header.hash = HashGameWorld(world);
+
+	FILE* file = fopen(fileName, "wb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(&world, sizeof(world), 1, file) == 1;
+	return fclose(file) == 0 && written;
+}
+
+bool LoadGameWorld(GameWorld& world, const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	SaveHeader header;
+	GameWorld loaded;
+
+	bool read = fread(&header, sizeof(header), 1, file) == 1 &&
+		memcmp(header.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) == 0 &&
+		header.version == SAVE_VERSION &&
+		header.worldSize == sizeof(loaded) &&
+		header.layout == SaveLayoutFingerprint() &&
+		fread(&loaded, sizeof(loaded), 1, file) == 1 &&
+		HashGameWorld(loaded) == header.hash &&
+		IsGameWorldValid(loaded); // the hash only catches accidents, the file could say anything
+
+	fclose(file);
+
+	if (read)
+	{
+		memcpy(&world, &loaded, sizeof(world));
+	}
+
+	return read;
+}
+
+// sizes, offsets and capacities of what a GameWorld is made of, so a build that lays it out differently
+// turns the save away even when the whole thing happens to come out the same size
+uint32_t SaveLayoutFingerprint()
+{
+	const uint64_t layout[] = {
+		sizeof(GameWorld), sizeof(Game), sizeof(Player), sizeof(Shield), sizeof(AlienSwarm),
+		offsetof(GameWorld, player), offsetof(GameWorld, shields), offsetof(GameWorld, aliens),
+		offsetof(Game, timers), offsetof(Game, random), offsetof(Game, stats),
+		offsetof(TimerWheel<MAX_GAME_TIMERS>, slots), offsetof(TimerWheel<MAX_GAME_TIMERS>, next), offsetof(TimerWheel<MAX_GAME_TIMERS>, events),
+		offsetof(AlienSwarm, lowestAlienInColumn), offsetof(AlienSwarm, shooterColumns), offsetof(AlienSwarm, numberOfShooterColumns),
+		offsetof(AlienSwarm, bombs), offsetof(AlienSwarm, animation),
+		MAX_GAME_TIMERS, TIMER_WHEEL_SLOTS, TIMER_WHEEL_LEVELS, MAX_NUMBER_ALIEN_BOMBS, NUM_SHIELDS,
+		AlienSwarm::Layout::NUM_ROWS, AlienSwarm::Layout::NUM_COLS
+	};
+
+	uint32_t fingerprint = 2166136261u; // FNV-1a
+
+	for (uint64_t value : layout)
+	{
+		fingerprint = (fingerprint ^ uint32_t(value)) * 16777619u;
+	}
+
+	return fingerprint;
+}
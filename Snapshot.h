@@ -0,0 +1,25 @@
+#pragma once
+#include "GameWorld.h"
+#include <vector>
+
+// Saved copies of a GameWorld. A GameWorld is one flat block, so taking or restoring a snapshot is a plain copy
+// and a saved game on disk is that block behind a small header. Saved games only load into the same build,
+// the header's version, size and layout checks turn anything else away, and a world that passes them still has every
+// count and index in it checked before it is used.
+
+// snapshots in memory, newest on top, allocated once up front so pushing never allocates
+struct SnapshotStack
+{
+	std::vector<GameWorld> snapshots;
+	int count;
+};
+
+void InitSnapshotStack(SnapshotStack& stack, int capacity);
+
+bool PushSnapshot(SnapshotStack& stack, const GameWorld& world); // false when the stack is full
+bool PopSnapshot(SnapshotStack& stack, GameWorld& world); // false when the stack is empty
+const GameWorld* PeekSnapshot(const SnapshotStack& stack, int depth); // 0 is the newest, NULL past the oldest
+void TruncateSnapshots(SnapshotStack& stack, int count); // forgets everything above the first count snapshots
+
+bool SaveGameWorld(const GameWorld& world, const char* fileName);
+bool LoadGameWorld(GameWorld& world, const char* fileName);
@@ -0,0 +1,89 @@
+#pragma once
+#include "BitUtils.h"
+
+// A sprite built by the compiler from string literals, one per row, every frame after the one before.
+// MakeSprite refuses to compile if the rows aren't all the same width or don't split evenly into frames,
+// so the sizes only live in the strings. Each row also gets a mask of its opaque (non space) cells and the run
+// from its first opaque cell to its last, so drawing copies known length spans and collisions can test exact cells.
+
+template<int WIDTH, int HEIGHT, int FRAMES>
+struct Sprite
+{
+	enum
+	{
+		SPRITE_WIDTH = WIDTH,
+		SPRITE_HEIGHT = HEIGHT,
+		NUM_FRAMES = FRAMES
+	};
+
+	char cells[FRAMES * HEIGHT][WIDTH]; // row h of frame f is cells[f * HEIGHT + h], no terminators
+	Bitmask opaque[FRAMES * HEIGHT]; // bit x is set where the cell isn't a space
+	int runStart[FRAMES * HEIGHT]; // first opaque cell in the row
+	int runLength[FRAMES * HEIGHT]; // from the first opaque cell to the last, 0 if the row is blank
+};
+
+constexpr bool RowsHaveLength(int)
+{
+	return true;
+}
+
+template<class... LENGTHS>
+constexpr bool RowsHaveLength(int length, int first, LENGTHS... rest)
+{
+	return first == length && RowsHaveLength(length, rest...);
+}
+
+// MakeSprite<2>("ab", "cd", "ef", "gh") is a 2x2 sprite with 2 frames
+template<int FRAMES, int FIRST_LENGTH, int... LENGTHS>
+constexpr Sprite<FIRST_LENGTH - 1, (1 + sizeof...(LENGTHS)) / FRAMES, FRAMES> MakeSprite(const char (&first)[FIRST_LENGTH], const char (&...rest)[LENGTHS])
+{
+	enum
+	{
+		WIDTH = FIRST_LENGTH - 1,
+		ROWS = 1 + sizeof...(LENGTHS)
+	};
+
+	static_assert(RowsHaveLength(FIRST_LENGTH, LENGTHS...), "every row of a sprite has to be the same width");
+	static_assert(ROWS % FRAMES == 0, "a sprite's rows have to split evenly into its frames");
+	static_assert(WIDTH > 0 && WIDTH <= BITMASK_BITS, "a sprite row has to fit in a Bitmask");
+
+	const char* const rows[ROWS] = { first, rest... };
+	Sprite<WIDTH, ROWS / FRAMES, FRAMES> sprite = {};
+
+	for (int row = 0; row < ROWS; row++)
+	{
+		int firstOpaque = WIDTH;
+		int lastOpaque = -1;
+
+		for (int x = 0; x < WIDTH; x++)
+		{
+			sprite.cells[row][x] = rows[row][x];
+
+			if (rows[row][x] != ' ')
+			{
+				sprite.opaque[row] |= Bitmask(1) << x;
+				firstOpaque = firstOpaque < x ? firstOpaque : x;
+				lastOpaque = x;
+			}
+		}
+
+		sprite.runStart[row] = lastOpaque < 0 ? 0 : firstOpaque;
+		sprite.runLength[row] = lastOpaque < 0 ? 0 : lastOpaque - firstOpaque + 1;
+	}
+
+	return sprite;
+}
+
+// the opaque masks of one frame, one Bitmask per row
+template<int WIDTH, int HEIGHT, int FRAMES>
+const Bitmask* FrameMask(const Sprite<WIDTH, HEIGHT, FRAMES>& sprite, int frame)
+{
+	return sprite.opaque + frame * HEIGHT;
+}
+
+// x and y are relative to the sprite's top left, anything outside it isn't opaque
+template<int WIDTH, int HEIGHT, int FRAMES>
+bool IsOpaque(const Sprite<WIDTH, HEIGHT, FRAMES>& sprite, int frame, int x, int y)
+{
+	return x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT && (sprite.opaque[frame * HEIGHT + y] >> x & 1) != 0;
+}
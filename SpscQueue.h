@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+
+// Fixed capacity queue from exactly one producer thread to exactly one consumer thread, with no locks.
+// The counters only ever go up and wrap around, CAPACITY has to be a power of two so they index correctly when they do.
+template<typename T, int CAPACITY>
+struct SpscQueue
+{
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue CAPACITY must be a power of two");
+
+	T items[CAPACITY];
+	alignas(64) std::atomic<unsigned> head; // next item to pop, written by the consumer
+	alignas(64) std::atomic<unsigned> tail; // next free slot, written by the producer
+};
+
+template<typename T, int CAPACITY>
+void InitQueue(SpscQueue<T, CAPACITY>& queue)
+{
+	queue.head.store(0, std::memory_order_relaxed);
+	queue.tail.store(0, std::memory_order_relaxed);
+}
+
+// returns false if the queue is full
+template<typename T, int CAPACITY>
+bool PushItem(SpscQueue<T, CAPACITY>& queue, const T& item)
+{
+	unsigned tail = queue.tail.load(std::memory_order_relaxed);
+
+	if (tail - queue.head.load(std::memory_order_acquire) == unsigned(CAPACITY))
+	{
+		return false;
+	}
+
+	queue.items[tail & (CAPACITY - 1)] = item;
+	queue.tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+// returns false if the queue is empty
+template<typename T, int CAPACITY>
+bool PopItem(SpscQueue<T, CAPACITY>& queue, T& item)
+{
+	unsigned head = queue.head.load(std::memory_order_relaxed);
+
+	if (head == queue.tail.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	item = queue.items[head & (CAPACITY - 1)];
+	queue.head.store(head + 1, std::memory_order_release);
+	return true;
+}
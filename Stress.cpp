@@ -0,0 +1,628 @@
+#include "Stress.h"
+#include "Profiler.h"
+#include <chrono>
+#include <algorithm>
+
+using namespace std::chrono;
+
+typedef ClassicSwarmLayout StressCell; // the size and spacing of each alien in a stress swarm
+
+void InitStressSwarm(StressSwarm& aliens, const StressSettings& settings);
+void InitStressGunners(StressWorld& world, int numberOfGunners);
+
+void MoveStressGunners(StressWorld& world);
+void CollideStressMissiles(StressWorld& world);
+void UpdateStressBombs(StressWorld& world);
+void RunStressEvents(StressWorld& world);
+
+void MoveStressSwarm(StressWorld& world);
+void ShootStressVolley(StressWorld& world);
+int DestroyStressShields(StressWorld& world);
+int DestroyStressShieldsBruteForce(StressWorld& world);
+
+int FindStressAlien(const StressSwarm& aliens, int x, int y);
+int FindStressAlienBruteForce(const StressSwarm& aliens, int x, int y);
+int ShootStressAlien(StressWorld& world, int alien);
+void KillStressAlien(StressSwarm& aliens, int alien);
+int GunnerInLane(const StressWorld& world, int x);
+
+int FloorDivide(int a, int b);
+int64_t StressTimestamp();
+
+bool InitStressWorld(StressWorld& world, const StressSettings& settings)
+{
+	const int width = settings.fieldSize.width;
+	const int height = settings.fieldSize.height;
+	const int shieldTop = height - PLAYER_SPRITE_HEIGHT - 1 - SHIELD_SPRITE_HEIGHT - 2; // where InitShields puts them
+	const int swarmHeight = settings.numberOfRows * StressCell::CELL_HEIGHT - StressCell::Y_PADDING;
+
+	if (settings.numberOfRows <= 0 || settings.numberOfColumns <= 0 ||
+		(long long)settings.numberOfRows * settings.numberOfColumns > MAX_STRESS_ALIENS ||
+		settings.numberOfColumns * StressCell::CELL_WIDTH - StressCell::X_PADDING > width ||
+		settings.startLines < 0 || shieldTop - settings.startLines - swarmHeight < 0 ||
+		settings.numberOfShields < 0 || settings.numberOfShields * SHIELD_SPRITE_WIDTH > width ||
+		settings.numberOfGunners <= 0 || settings.numberOfGunners > MAX_STRESS_GUNNERS ||
+		width / settings.numberOfGunners <= PLAYER_SPRITE_WIDTH ||
+		settings.maxBombs <= 0 || settings.maxBombs > MAX_STRESS_BOMBS)
+	{
+		return false;
+	}
+
+	InitGame(world.game, settings.fieldSize, settings.seed);
+	InitTimerWheel(world.explosions);
+
+	world.shields.resize(settings.numberOfShields);
+	InitShields(world.game, world.shields.data(), settings.numberOfShields);
+
+	InitStressGunners(world, settings.numberOfGunners);
+	InitStressSwarm(world.aliens, settings);
+
+	// the bottom row starts startLines above the shields and can come down until it is just above the gunners
+	world.aliens.position.x = (width - settings.numberOfColumns * StressCell::CELL_WIDTH) / 2;
+	world.aliens.position.y = shieldTop - settings.startLines - swarmHeight;
+	world.aliens.line = settings.startLines + SHIELD_SPRITE_HEIGHT + 2;
+
+	world.maxBombs = settings.maxBombs;
+	world.bruteForce = settings.bruteForce;
+
+	for (int phase = 0; phase < NUM_STRESS_PHASES; phase++)
+	{
+		world.phaseNanoseconds[phase] = 0;
+	}
+
+	const StressSwarm& aliens = world.aliens;
+	int numberOfAliens = aliens.numberOfRows * aliens.numberOfColumns;
+
+	ScheduleTimer(world.game.timers, SwarmStepDelay(aliens.line, numberOfAliens, aliens.numAliensLeft), GE_SWARM_STEP, 0);
+	ScheduleTimer(world.game.timers, TicksUntilBombVolley(numberOfAliens, aliens.numAliensLeft, world.game.random), GE_BOMB_VOLLEY, 0);
+
+	return true;
+}
+
+void InitStressSwarm(StressSwarm& aliens, const StressSettings& settings)
+{
+	const int rows = settings.numberOfRows;
+	const int cols = settings.numberOfColumns;
+
+	aliens.numberOfRows = rows;
+	aliens.numberOfColumns = cols;
+	aliens.animation = 0;
+	aliens.direction = 1; // going to the right
+	aliens.numAliensLeft = rows * cols;
+	aliens.firstColumn = 0;
+	aliens.lastColumn = cols - 1;
+	aliens.lastRow = rows - 1;
+
+	aliens.columnOffset.resize(cols);
+	aliens.rowOffset.resize(rows);
+	aliens.rowType.resize(rows);
+
+	for (int col = 0; col < cols; col++)
+	{
+		aliens.columnOffset[col] = col * StressCell::CELL_WIDTH;
+	}
+
+	for (int row = 0; row < rows; row++)
+	{
+		aliens.rowOffset[row] = row * StressCell::CELL_HEIGHT;
+		aliens.rowType[row] = AlienTypeOfRow(row, rows);
+	}
+
+	aliens.state.assign(rows * cols, (unsigned char)AS_ALIVE);
+	aliens.occupiedInColumn.assign(cols, rows);
+	aliens.occupiedInRow.assign(rows, cols);
+	aliens.lowestAlienInColumn.assign(cols, rows - 1);
+	aliens.shooterColumns.resize(cols);
+	aliens.shooterColumnIndex.resize(cols);
+
+	for (int col = 0; col < cols; col++)
+	{
+		aliens.shooterColumns[col] = col;
+		aliens.shooterColumnIndex[col] = col;
+	}
+
+	aliens.numberOfShooterColumns = cols;
+
+	InitProjectiles(aliens.bombs);
+}
+
+// each gunner gets an equal stretch of the bottom of the board to sweep
+void InitStressGunners(StressWorld& world, int numberOfGunners)
+{
+	const int width = world.game.windowSize.width;
+
+	world.gunners.resize(numberOfGunners);
+	world.gunnerDirection.resize(numberOfGunners);
+
+	for (int i = 0; i < numberOfGunners; i++)
+	{
+		Player& gunner = world.gunners[i];
+		InitPlayer(world.game, gunner);
+
+		int laneStart = i * width / numberOfGunners;
+		int laneEnd = (i + 1) * width / numberOfGunners;
+
+		gunner.position.x = laneStart + (laneEnd - laneStart - gunner.spriteSize.width) / 2;
+		world.gunnerDirection[i] = i % 2 == 0 ? 1 : -1;
+	}
+}
+
+bool IsStressSwarmEmpty(const StressSwarm& aliens)
+{
+	return aliens.firstColumn > aliens.lastColumn;
+}
+
+void StepStressWorld(StressWorld& world)
+{
+	PROFILE_SCOPE("StepStressWorld");
+
+	world.game.stats.frames++;
+
+	// like UpdateGame, timers scheduled during the tick count from it and the ones due on it run at the end
+	AdvanceTimers(world.game.timers);
+	AdvanceTimers(world.explosions);
+
+	world.phaseNanoseconds[SP_SWARM_STEP] = 0;
+	world.phaseNanoseconds[SP_DESTROY_SHIELDS] = 0;
+
+	int64_t startTime = StressTimestamp();
+	MoveStressGunners(world);
+
+	int64_t gunnersTime = StressTimestamp();
+	CollideStressMissiles(world);
+
+	int64_t missilesTime = StressTimestamp();
+	UpdateStressBombs(world);
+
+	int64_t bombsTime = StressTimestamp();
+	RunStressEvents(world); // fills in the swarm step and shield times itself
+
+	int64_t endTime = StressTimestamp();
+
+	world.phaseNanoseconds[SP_GUNNERS] = gunnersTime - startTime;
+	world.phaseNanoseconds[SP_MISSILE_COLLISIONS] = missilesTime - gunnersTime;
+	world.phaseNanoseconds[SP_BOMBS] = bombsTime - missilesTime;
+	world.phaseNanoseconds[SP_EVENTS] = endTime - bombsTime - world.phaseNanoseconds[SP_SWARM_STEP] - world.phaseNanoseconds[SP_DESTROY_SHIELDS];
+}
+
+// the sim's sweep policy for every gunner, within its own stretch of the board
+void MoveStressGunners(StressWorld& world)
+{
+	const int numberOfGunners = int(world.gunners.size());
+	const int width = world.game.windowSize.width;
+
+	for (int i = 0; i < numberOfGunners; i++)
+	{
+		Player& gunner = world.gunners[i];
+		int laneStart = i * width / numberOfGunners;
+		int laneEnd = (i + 1) * width / numberOfGunners;
+
+		if (gunner.position.x + gunner.spriteSize.width >= laneEnd)
+		{
+			world.gunnerDirection[i] = -1;
+		}
+		else if (gunner.position.x <= laneStart)
+		{
+			world.gunnerDirection[i] = 1;
+		}
+
+		MovePlayer(world.game, gunner, world.gunnerDirection[i] * PLAYER_MOVEMENT_AMOUNT);
+		PlayerShoot(gunner);
+		UpdateMissile(gunner);
+	}
+}
+
+void CollideStressMissiles(StressWorld& world)
+{
+	PROFILE_SCOPE("CollideStressMissiles");
+
+	for (Player& gunner : world.gunners)
+	{
+		if (gunner.missile.y == NOT_IN_PLAY)
+		{
+			continue;
+		}
+
+		Position shieldCollidePoint;
+		int shieldIndex = IsCollision(gunner.missile, world.shields.data(), int(world.shields.size()), shieldCollidePoint);
+
+		if (shieldIndex != NOT_IN_PLAY)
+		{
+			ResetMissile(gunner);
+			ResolveShieldCollision(world.shields.data(), shieldIndex, shieldCollidePoint);
+			world.game.stats.shieldCellsDestroyed++;
+			continue;
+		}
+
+		int alien = world.bruteForce ? FindStressAlienBruteForce(world.aliens, gunner.missile.x, gunner.missile.y) :
+			FindStressAlien(world.aliens, gunner.missile.x, gunner.missile.y);
+
+		if (alien != NOT_IN_PLAY)
+		{
+			ResetMissile(gunner);
+			gunner.score += ShootStressAlien(world, alien);
+		}
+	}
+}
+
+// the alien at (x, y) if it is alive and that is one of its opaque cells, NOT_IN_PLAY if not.
+// Like the classic swarm's IsCollision it only looks at the one cell of the swarm the point is in
+int FindStressAlien(const StressSwarm& aliens, int x, int y)
+{
+	if (IsStressSwarmEmpty(aliens))
+	{
+		return NOT_IN_PLAY;
+	}
+
+	int dx = x - aliens.position.x;
+	int dy = y - aliens.position.y;
+
+	if (dx < aliens.columnOffset[aliens.firstColumn] || dx >= aliens.columnOffset[aliens.lastColumn] + StressCell::CELL_WIDTH ||
+		dy < 0 || dy >= aliens.rowOffset[aliens.lastRow] + StressCell::CELL_HEIGHT)
+	{
+		return NOT_IN_PLAY;
+	}
+
+	int col = dx / StressCell::CELL_WIDTH;
+	int row = dy / StressCell::CELL_HEIGHT;
+	int alien = row * aliens.numberOfColumns + col;
+
+	if (aliens.state[alien] == AS_ALIVE &&
+		IsOpaque(*ALIEN_SPRITES[aliens.rowType[row]], aliens.animation, dx - aliens.columnOffset[col], dy - aliens.rowOffset[row]))
+	{
+		return alien;
+	}
+
+	return NOT_IN_PLAY;
+}
+
+// tests every living alien, FindStressAlien has to give the same answer
+int FindStressAlienBruteForce(const StressSwarm& aliens, int x, int y)
+{
+	for (int row = 0; row < aliens.numberOfRows; row++)
+	{
+		const AlienSprite& sprite = *ALIEN_SPRITES[aliens.rowType[row]];
+		const unsigned char* state = &aliens.state[row * aliens.numberOfColumns];
+		int alienY = aliens.position.y + aliens.rowOffset[row];
+
+		for (int col = 0; col < aliens.numberOfColumns; col++)
+		{
+			if (state[col] == AS_ALIVE && IsOpaque(sprite, aliens.animation, x - aliens.position.x - aliens.columnOffset[col], y - alienY))
+			{
+				return row * aliens.numberOfColumns + col;
+			}
+		}
+	}
+
+	return NOT_IN_PLAY;
+}
+
+// leaves the alien exploding until its timer runs out and returns its points
+int ShootStressAlien(StressWorld& world, int alien)
+{
+	StressSwarm& aliens = world.aliens;
+	int row = alien / aliens.numberOfColumns;
+	int col = alien % aliens.numberOfColumns;
+
+	aliens.state[alien] = AS_EXPLODING;
+	aliens.numAliensLeft--;
+
+	if (aliens.lowestAlienInColumn[col] == row)
+	{
+		int lowest = row - 1;
+		while (lowest >= 0 && aliens.state[lowest * aliens.numberOfColumns + col] != AS_ALIVE)
+		{
+			lowest--;
+		}
+
+		aliens.lowestAlienInColumn[col] = lowest >= 0 ? lowest : NOT_IN_PLAY;
+
+		if (lowest < 0)
+		{
+			// swap the last shooter column into this column's place
+			int index = aliens.shooterColumnIndex[col];
+			int lastColumn = aliens.shooterColumns[aliens.numberOfShooterColumns - 1];
+
+			aliens.shooterColumns[index] = lastColumn;
+			aliens.shooterColumnIndex[lastColumn] = index;
+			aliens.shooterColumnIndex[col] = NOT_IN_PLAY;
+			aliens.numberOfShooterColumns--;
+		}
+	}
+
+	if (!ScheduleTimer(world.explosions, ALIENS_EXPLOSION_TIME, GE_EXPLOSION_END, alien))
+	{
+		KillStressAlien(aliens, alien); // no timer to spare, skip the explosion
+	}
+
+	return AlienTypePoints(aliens.rowType[row]);
+}
+
+// the alien is gone for good, the swarm's bounds close in past any column or row that is now empty
+void KillStressAlien(StressSwarm& aliens, int alien)
+{
+	int row = alien / aliens.numberOfColumns;
+	int col = alien % aliens.numberOfColumns;
+
+	aliens.state[alien] = AS_DEAD;
+
+	if (--aliens.occupiedInColumn[col] == 0)
+	{
+		while (aliens.firstColumn <= aliens.lastColumn && aliens.occupiedInColumn[aliens.firstColumn] == 0)
+		{
+			aliens.firstColumn++;
+		}
+
+		while (aliens.lastColumn >= aliens.firstColumn && aliens.occupiedInColumn[aliens.lastColumn] == 0)
+		{
+			aliens.lastColumn--;
+		}
+	}
+
+	if (--aliens.occupiedInRow[row] == 0)
+	{
+		while (aliens.lastRow >= 0 && aliens.occupiedInRow[aliens.lastRow] == 0)
+		{
+			aliens.lastRow--;
+		}
+	}
+}
+
+void UpdateStressBombs(StressWorld& world)
+{
+	PROFILE_SCOPE("UpdateStressBombs");
+
+	ProjectilePool<MAX_STRESS_BOMBS>& bombs = world.aliens.bombs;
+	Shield* shields = world.shields.data();
+	const int numberOfShields = int(world.shields.size());
+
+	MoveProjectiles(bombs, ALIEN_BOMB_SPEED, ALIEN_BOMB_SPRITE.NUM_FRAMES);
+
+	// backwards, so removing a bomb only moves bombs we've already looked at
+	for (int i = bombs.count - 1; i >= 0; i--)
+	{
+		Position position = { bombs.x[i], bombs.y[i] };
+		Position collisionPoint;
+		int shieldIndex = IsCollision(position, shields, numberOfShields, collisionPoint);
+		int gunner = GunnerInLane(world, position.x);
+
+		if (shieldIndex != NOT_IN_PLAY)
+		{
+			RemoveProjectile(bombs, i);
+			ResolveShieldCollision(shields, shieldIndex, collisionPoint);
+			world.game.stats.shieldCellsDestroyed++;
+		}
+		else if (gunner != NOT_IN_PLAY && IsOpaque(PLAYER_SPRITE, 0, position.x - world.gunners[gunner].position.x, position.y - world.gunners[gunner].position.y))
+		{
+			RemoveProjectile(bombs, i);
+			world.game.stats.playerHits++;
+		}
+		else if (position.y >= world.game.windowSize.height)
+		{
+			RemoveProjectile(bombs, i);
+		}
+	}
+}
+
+// a gunner never leaves its stretch of the board, so only the one whose stretch x is in can be hit there
+int GunnerInLane(const StressWorld& world, int x)
+{
+	const int numberOfGunners = int(world.gunners.size());
+	const int width = world.game.windowSize.width;
+
+	if (x < 0 || x >= width)
+	{
+		return NOT_IN_PLAY;
+	}
+
+	int gunner = int((long long)x * numberOfGunners / width);
+
+	while (gunner + 1 < numberOfGunners && (gunner + 1) * width / numberOfGunners <= x)
+	{
+		gunner++;
+	}
+
+	while (gunner > 0 && gunner * width / numberOfGunners > x)
+	{
+		gunner--;
+	}
+
+	return gunner;
+}
+
+void RunStressEvents(StressWorld& world)
+{
+	PROFILE_SCOPE("RunStressEvents");
+
+	TimerEvent event;
+
+	while (NextDueTimer(world.game.timers, event))
+	{
+		if (event.type == GE_SWARM_STEP)
+		{
+			MoveStressSwarm(world);
+		}
+		else if (event.type == GE_BOMB_VOLLEY)
+		{
+			const StressSwarm& aliens = world.aliens;
+
+			ShootStressVolley(world);
+			ScheduleTimer(world.game.timers, TicksUntilBombVolley(aliens.numberOfRows * aliens.numberOfColumns, aliens.numAliensLeft, world.game.random), GE_BOMB_VOLLEY, 0);
+		}
+	}
+
+	while (NextDueTimer(world.explosions, event))
+	{
+		if (world.aliens.state[event.data] == AS_EXPLODING)
+		{
+			KillStressAlien(world.aliens, event.data);
+		}
+	}
+}
+
+// MoveSwarm for a stress swarm, with the swarm step and the shields it eats timed apart
+void MoveStressSwarm(StressWorld& world)
+{
+	int64_t startTime = StressTimestamp();
+
+	StressSwarm& aliens = world.aliens;
+
+	if (IsStressSwarmEmpty(aliens))
+	{
+		return; // nothing left to move, and never will be
+	}
+
+	int leftAlienPosition = aliens.position.x + aliens.columnOffset[aliens.firstColumn];
+	int rightAlienPosition = aliens.position.x + aliens.columnOffset[aliens.lastColumn] + StressCell::SPRITE_WIDTH;
+
+	if (((rightAlienPosition >= world.game.windowSize.width && aliens.direction > 0) ||
+		(leftAlienPosition <= 0 && aliens.direction < 0)) &&
+		aliens.line > 0)
+	{
+		aliens.position.y++;
+		aliens.line--;
+		aliens.direction = -aliens.direction;
+	}
+	else
+	{
+		aliens.position.x += aliens.direction;
+		aliens.animation = aliens.animation == 0 ? 1 : 0;
+	}
+
+	ScheduleTimer(world.game.timers, SwarmStepDelay(aliens.line, aliens.numberOfRows * aliens.numberOfColumns, aliens.numAliensLeft), GE_SWARM_STEP, 0);
+
+	int64_t shieldsTime = StressTimestamp();
+
+	world.game.stats.shieldCellsDestroyed += world.bruteForce ? DestroyStressShieldsBruteForce(world) : DestroyStressShields(world);
+
+	int64_t endTime = StressTimestamp();
+
+	world.phaseNanoseconds[SP_SWARM_STEP] += shieldsTime - startTime;
+	world.phaseNanoseconds[SP_DESTROY_SHIELDS] += endTime - shieldsTime;
+}
+
+void ShootStressVolley(StressWorld& world)
+{
+	StressSwarm& aliens = world.aliens;
+	int numActiveCols = aliens.numberOfShooterColumns;
+
+	if (numActiveCols == 0)
+	{
+		return;
+	}
+
+	int numberOfShots = (RandomInt(world.game.random, world.maxBombs) + 1) - aliens.bombs.count;
+
+	for (int i = 0; i < numberOfShots; i++)
+	{
+		int col = aliens.shooterColumns[RandomInt(world.game.random, numActiveCols)];
+		int x = aliens.position.x + aliens.columnOffset[col] + 1; // roughly middle of the alien
+		int y = aliens.position.y + aliens.rowOffset[aliens.lowestAlienInColumn[col]] + StressCell::SPRITE_HEIGHT; // bottom of alien
+
+		if (SpawnProjectile(aliens.bombs, x, y))
+		{
+			world.game.stats.bombsFired++;
+		}
+	}
+}
+
+// only the rows and columns of the swarm that can reach each shield are looked at. The shields are in a line from left
+// to right, so an alien that reaches two of them is only tested against the first, as DestroyShields would
+int DestroyStressShields(StressWorld& world)
+{
+	const StressSwarm& aliens = world.aliens;
+	const Size spriteSize = { StressCell::SPRITE_WIDTH, StressCell::SPRITE_HEIGHT };
+	int cellsDestroyed = 0;
+
+	if (IsStressSwarmEmpty(aliens))
+	{
+		return 0;
+	}
+
+	int lastColumnTested = aliens.firstColumn - 1;
+
+	for (Shield& shield : world.shields)
+	{
+		// the same overlap test as CollideShieldsWithAlien, solved for the rows and columns
+		int firstRow = std::max(FloorDivide(shield.position.y - StressCell::SPRITE_HEIGHT - aliens.position.y - 1, StressCell::CELL_HEIGHT) + 1, 0);
+		int lastRow = std::min(FloorDivide(shield.position.y + SHIELD_SPRITE_HEIGHT - 1 - aliens.position.y, StressCell::CELL_HEIGHT), aliens.lastRow);
+		int firstColumn = std::max(FloorDivide(shield.position.x - StressCell::SPRITE_WIDTH - aliens.position.x - 1, StressCell::CELL_WIDTH) + 1, lastColumnTested + 1);
+		int lastColumn = std::min(FloorDivide(shield.position.x + SHIELD_SPRITE_WIDTH - 1 - aliens.position.x, StressCell::CELL_WIDTH), aliens.lastColumn);
+
+		for (int row = firstRow; row <= lastRow; row++)
+		{
+			const Bitmask* alienRows = FrameMask(*ALIEN_SPRITES[aliens.rowType[row]], aliens.animation);
+			int y = aliens.position.y + aliens.rowOffset[row];
+
+			for (int col = firstColumn; col <= lastColumn; col++)
+			{
+				if (aliens.state[row * aliens.numberOfColumns + col] == AS_ALIVE)
+				{
+					cellsDestroyed += CollideShieldsWithAlien(&shield, 1, aliens.position.x + aliens.columnOffset[col], y, alienRows, spriteSize);
+				}
+			}
+		}
+
+		lastColumnTested = std::max(lastColumnTested, lastColumn);
+	}
+
+	return cellsDestroyed;
+}
+
+// DestroyShields as the game does it, every living alien against every shield
+int DestroyStressShieldsBruteForce(StressWorld& world)
+{
+	const StressSwarm& aliens = world.aliens;
+	const Size spriteSize = { StressCell::SPRITE_WIDTH, StressCell::SPRITE_HEIGHT };
+	int cellsDestroyed = 0;
+
+	for (int row = 0; row < aliens.numberOfRows; row++)
+	{
+		const Bitmask* alienRows = FrameMask(*ALIEN_SPRITES[aliens.rowType[row]], aliens.animation);
+		const unsigned char* state = &aliens.state[row * aliens.numberOfColumns];
+		int y = aliens.position.y + aliens.rowOffset[row];
+
+		for (int col = 0; col < aliens.numberOfColumns; col++)
+		{
+			if (state[col] == AS_ALIVE)
+			{
+				cellsDestroyed += CollideShieldsWithAlien(world.shields.data(), int(world.shields.size()),
+					aliens.position.x + aliens.columnOffset[col], y, alienRows, spriteSize);
+			}
+		}
+	}
+
+	return cellsDestroyed;
+}
+
+const char* StressPhaseName(int phase)
+{
+	switch (phase)
+	{
+	case SP_GUNNERS:
+		return "gunners";
+	case SP_MISSILE_COLLISIONS:
+		return "missile_collisions";
+	case SP_BOMBS:
+		return "bombs";
+	case SP_SWARM_STEP:
+		return "swarm_step";
+	case SP_DESTROY_SHIELDS:
+		return "destroy_shields";
+	case SP_EVENTS:
+		return "events";
+	default:
+		return "unknown";
+	}
+}
+
+// rounds towards minus infinity, b must be > 0
+int FloorDivide(int a, int b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+int64_t StressTimestamp()
+{
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
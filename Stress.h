@@ -0,0 +1,93 @@
+#pragma once
+#include "GameWorld.h"
+#include <vector>
+
+// Stress mode: the game's rules on a playfield and a swarm whose sizes are only known at run time, up to
+// MAX_STRESS_ALIENS aliens on a board thousands of cells across, for finding out how the engine scales before we ship
+// bigger variants. It isn't a GameWorld. The swarm is a structure of arrays, one byte of state per alien plus tables per
+// row and column, and everything else that grows with the board lives in vectors. The aliens are the classic ones,
+// spaced like the classic swarm. Gunners spread along the bottom sweep their own stretch of it and fire whenever
+// they can; they can't die, bombs that hit them are only counted, so a run lasts as long as it is asked to.
+// Every tick records how long each of its phases took.
+
+enum
+{
+	MAX_STRESS_ALIENS = 100000,
+	MAX_STRESS_GUNNERS = 64,
+	MAX_STRESS_BOMBS = 1024,
+	MAX_STRESS_EXPLOSIONS = 1024 // each gunner can start one a tick and they last ALIENS_EXPLOSION_TIME, with room to spare
+};
+
+enum StressPhase
+{
+	SP_GUNNERS = 0, // moving the gunners and their missiles
+	SP_MISSILE_COLLISIONS, // missiles against the shields and the swarm
+	SP_BOMBS, // moving the bombs, and hitting shields and gunners
+	SP_SWARM_STEP, // the swarm moving across or down, without the shields it eats on the way
+	SP_DESTROY_SHIELDS,
+	SP_EVENTS, // everything else the timers do, volleys and explosions ending
+	NUM_STRESS_PHASES
+};
+
+struct StressSettings
+{
+	Size fieldSize;
+	int numberOfRows;
+	int numberOfColumns;
+	int numberOfShields;
+	int numberOfGunners;
+	int maxBombs; // bombs in play at once
+	int startLines; // how many times the swarm comes down before it reaches the shields
+	bool bruteForce; // test every alien for missile hits and eroded shields, instead of just the ones in reach
+	uint64_t seed;
+};
+
+struct StressSwarm
+{
+	int numberOfRows;
+	int numberOfColumns;
+	Position position;
+	int animation;
+	int direction; // >0 - for going right, <0 - for going left
+	int numAliensLeft;
+	int line; // how many more times the swarm can come down
+
+	// what is still alive or exploding is within these, they only shrink, so keeping them costs nothing a step
+	int firstColumn;
+	int lastColumn;
+	int lastRow;
+
+	std::vector<int> columnOffset; // x of each column from the swarm's position, like SwarmLayout's tables
+	std::vector<int> rowOffset;
+	std::vector<int> rowType; // an AlienType
+
+	std::vector<unsigned char> state; // an AlienState for each alien, row * numberOfColumns + col
+
+	std::vector<int> occupiedInColumn; // aliens alive or exploding in each column
+	std::vector<int> occupiedInRow;
+	std::vector<int> lowestAlienInColumn; // row of the lowest living alien in each column, NOT_IN_PLAY if there is none
+	std::vector<int> shooterColumns; // the columns that still have a living alien, in no particular order
+	std::vector<int> shooterColumnIndex; // where each column is in shooterColumns, NOT_IN_PLAY if it isn't
+	int numberOfShooterColumns;
+
+	ProjectilePool<MAX_STRESS_BOMBS> bombs;
+};
+
+struct StressWorld
+{
+	Game game; // the board, random numbers and stats, and timers for the swarm's steps and volleys
+	TimerWheel<MAX_STRESS_EXPLOSIONS> explosions; // GE_EXPLOSION_END for each alien shot, more at once than game.timers holds
+	std::vector<Player> gunners;
+	std::vector<int> gunnerDirection;
+	std::vector<Shield> shields;
+	StressSwarm aliens;
+	int maxBombs;
+	bool bruteForce;
+	int64_t phaseNanoseconds[NUM_STRESS_PHASES]; // how long each phase of the last tick took
+};
+
+bool InitStressWorld(StressWorld& world, const StressSettings& settings); // false if the swarm, shields or gunners don't fit the board
+void StepStressWorld(StressWorld& world);
+bool IsStressSwarmEmpty(const StressSwarm& aliens);
+
+const char* StressPhaseName(int phase); // for reports
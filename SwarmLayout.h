@@ -0,0 +1,116 @@
+#pragma once
+#include "BitUtils.h"
+
+// The shape of an alien swarm, fixed at compile time: how many rows and columns of aliens,
+// how big each sprite is and the gap between them.
+// Where each row and column sits relative to the swarm's position, and which kind of alien each row holds,
+// are worked out by the compiler into tables, so code walking the swarm looks them up instead of multiplying them out,
+// and loops over the rows and columns have a fixed trip count.
+
+enum AlienType
+{
+	AT_30_POINTS = 0, // top fifth of the rows
+	AT_20_POINTS, // next two fifths
+	AT_10_POINTS, // the rest
+	NUM_ALIEN_TYPES
+};
+
+template<int N>
+struct SwarmTable
+{
+	int values[N];
+
+	constexpr int operator[](int i) const
+	{
+		return values[i];
+	}
+};
+
+// entry i is i * step
+template<int N>
+constexpr SwarmTable<N> MakeOffsetTable(int step)
+{
+	SwarmTable<N> table = {};
+
+	for (int i = 0; i < N; i++)
+	{
+		table.values[i] = i * step;
+	}
+
+	return table;
+}
+
+// the classic five rows come out as 30, 20, 20, 10, 10 points
+constexpr int AlienTypeOfRow(int row, int numberOfRows)
+{
+	return row * 5 / numberOfRows < 1 ? AT_30_POINTS : row * 5 / numberOfRows < 3 ? AT_20_POINTS : AT_10_POINTS;
+}
+
+constexpr int AlienTypePoints(int type)
+{
+	return type == AT_30_POINTS ? 30 : type == AT_20_POINTS ? 20 : 10;
+}
+
+template<int ROWS>
+constexpr SwarmTable<ROWS> MakeRowTypeTable()
+{
+	SwarmTable<ROWS> table = {};
+
+	for (int row = 0; row < ROWS; row++)
+	{
+		table.values[row] = AlienTypeOfRow(row, ROWS);
+	}
+
+	return table;
+}
+
+template<int ROWS>
+constexpr SwarmTable<ROWS> MakeRowPointsTable()
+{
+	SwarmTable<ROWS> table = {};
+
+	for (int row = 0; row < ROWS; row++)
+	{
+		table.values[row] = AlienTypePoints(AlienTypeOfRow(row, ROWS));
+	}
+
+	return table;
+}
+
+template<int ROWS, int COLS, int WIDTH, int HEIGHT, int XPADDING, int YPADDING>
+struct SwarmLayout
+{
+	static_assert(ROWS > 0 && COLS > 0 && ROWS <= BITMASK_BITS && COLS <= BITMASK_BITS, "the alien swarm has to fit in a Bitmask");
+
+	enum
+	{
+		NUM_ROWS = ROWS,
+		NUM_COLS = COLS,
+		NUM_ALIENS = ROWS * COLS,
+		SPRITE_WIDTH = WIDTH,
+		SPRITE_HEIGHT = HEIGHT,
+		X_PADDING = XPADDING,
+		Y_PADDING = YPADDING,
+		CELL_WIDTH = WIDTH + XPADDING, // from the left of one alien to the left of the next
+		CELL_HEIGHT = HEIGHT + YPADDING,
+		SWARM_WIDTH = COLS * CELL_WIDTH - XPADDING,
+		SWARM_HEIGHT = ROWS * CELL_HEIGHT - YPADDING
+	};
+
+	static constexpr SwarmTable<COLS> columnOffset = MakeOffsetTable<COLS>(CELL_WIDTH); // x of each column from the swarm's position
+	static constexpr SwarmTable<ROWS> rowOffset = MakeOffsetTable<ROWS>(CELL_HEIGHT); // y of each row from the swarm's position
+	static constexpr SwarmTable<ROWS> rowType = MakeRowTypeTable<ROWS>(); // an AlienType
+	static constexpr SwarmTable<ROWS> rowPoints = MakeRowPointsTable<ROWS>(); // what shooting an alien in the row scores
+};
+
+template<int ROWS, int COLS, int WIDTH, int HEIGHT, int XPADDING, int YPADDING>
+constexpr SwarmTable<COLS> SwarmLayout<ROWS, COLS, WIDTH, HEIGHT, XPADDING, YPADDING>::columnOffset;
+
+template<int ROWS, int COLS, int WIDTH, int HEIGHT, int XPADDING, int YPADDING>
+constexpr SwarmTable<ROWS> SwarmLayout<ROWS, COLS, WIDTH, HEIGHT, XPADDING, YPADDING>::rowOffset;
+
+template<int ROWS, int COLS, int WIDTH, int HEIGHT, int XPADDING, int YPADDING>
+constexpr SwarmTable<ROWS> SwarmLayout<ROWS, COLS, WIDTH, HEIGHT, XPADDING, YPADDING>::rowType;
+
+template<int ROWS, int COLS, int WIDTH, int HEIGHT, int XPADDING, int YPADDING>
+constexpr SwarmTable<ROWS> SwarmLayout<ROWS, COLS, WIDTH, HEIGHT, XPADDING, YPADDING>::rowPoints;
@@ -1,824 +1,387 @@
 #include <iostream>
-#include "TextInvaders.h"
+#include "GameWorld.h"
 #include "CursesUtils.h"
+#include "Renderer.h"
+#include "GameDraw.h"
+#include "PerformanceHud.h"
+#include "Replay.h"
+#include "Snapshot.h"
+#include "Profiler.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "Autopilot.h"
+#include "ThreadPool.h"
 #include <string>
 #include <ctime>
-#include <cmath>
-#include <cstring>
 #include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <atomic>
 
-void InitGame(Game& game);
-
-void InitPlayer(const Game& game, Player& player);
-void InitShields(const Game& game, Shield shields[], int numberOfShields);
-void InitAliens(const Game& game, AlienSwarm& aliens);
-
-void DrawGame(const Game& game, const Player& player, Shield shields[], int numberOfShields, const AlienSwarm& aliens);
-void DrawPlayer(const Player& player, const char* sprite[]);
-void DrawShields(const Shield shields[], int numberOfShields);
-void DrawAliens(const AlienSwarm& aliens);
-
-void ResetPlayer(const Game& game, Player& player);
-void ResetMissile(Player& player);
-void ResetMovementTime(AlienSwarm& aliens);
-
-void UpdateGame(Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarm& aliens);
-
-int HandleInput(Game& game, Player& player);
-void MovePlayer(const Game& game, Player& player, int dx);
-void PlayerShoot(Player& player);
-
-void UpdateMissile(Player& player);
-bool UpdateAliens(const Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields);
-void FindEmptyRowsAndColumns(const AlienSwarm& aliens, int& emptyColsLeft, int& emptyColsRight, int& emptyRowsBottom);
-
-int IsCollision(const Position& projectile, const Shield shields[], int numberOfShields, Position& shieldCollidePoint);
-bool IsCollision(const Player& player, const AlienSwarm& aliens, Position& alienCollidePositionInArray);
-bool IsCollision(const Position& projectile, const Position& spritePosition, const Size& spriteSize);
-
-void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollidePoint);
-int ResolveAlienCollision(AlienSwarm& aliens, const Position& hitPositionInAliensArray);
-void DestroyShields(const AlienSwarm& aliens, Shield shields[], int numberOfShields);
-void CollideShieldsWithAlien(Shield shields[], int numberOfShields, int x, int y, const Size& spriteSize);
-
-void CleanUpShields(Shield shields[], int numberOfShields);
+using namespace std::chrono;
 
-bool ShouldShootBomb(const AlienSwarm& aliens);
-void ShootBomb(AlienSwarm& aliens, int columnToShoot);
-bool UpdateBombs(const Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields);
+const int INPUT_QUEUE_SIZE = 256;
 
-int main()
+// everything the simulation thread owns, and the two ways in and out of it
+struct Simulation
 {
-	srand(time(NULL));
+	GameWorld world; // only touched by the simulation thread while it runs
+	Replay replay; // likewise
+	TripleBuffer<GameWorld> snapshots; // a copy of world after every tick, for drawing
+	SpscQueue<int, INPUT_QUEUE_SIZE> inputs; // GameInput flags from the keyboard, all of them since the last tick are combined
+	std::atomic<bool> stopping;
+	std::atomic<bool> autopilotOn; // 'a' toggles it, while it's on the autopilot plays and the keys are ignored
+	Autopilot autopilot; // only touched by the simulation thread
+	ThreadPool pool; // the autopilot's rollouts
+	steady_clock::time_point startTime; // ticks are due at startTime + n * TickDuration()
+};
 
-	Game game;
-	Player player;
-	Shield shields[NUM_SHIELDS];
-	AlienSwarm aliens;
+void RunSimulation(Simulation& simulation);
+steady_clock::duration TickDuration();
 
-	InitializeCurses(true);
+int HandleInput(int& gameInput, int timeoutMilliseconds);
 
-	InitGame(game);
-	InitPlayer(game, player);
-	InitShields(game, shields, NUM_SHIELDS);
-	InitAliens(game, aliens);
+int RunReplay(const char* fileName);
 
+int64_t Microseconds(steady_clock::time_point time);
 
+#ifdef TEXTINVADERS_PROFILE
+// 'p' saves these while playing, they are saved again on exit
+const char* const PROFILE_TRACE_FILE = "textinvaders-trace.json";
+const char* const PROFILE_SUMMARY_FILE = "textinvaders-profile.txt";
 
-	bool quit = false;
-	int input;
+void SaveProfile();
+#endif
 
-	clock_t lastTime = clock();
+// textinvaders [--record file] [--replay file] [--save file] [--resume file] [--backend curses|ansi] [--autopilot]
+int main(int argc, char* argv[])
+{
+	const char* recordFileName = NULL;
+	const char* saveFileName = NULL; // the game is saved here on quitting
+	const char* resumeFileName = NULL;
+	OutputBackend backend = OB_CURSES;
+	bool autopilotOn = false; // starting with it on makes an attract mode
 
-	while (!quit)
+	for (int i = 1; i < argc; i++)
 	{
-		input = HandleInput(game, player);
-		if (input != 'q')
-		{
-			clock_t currentTime = clock();
-			clock_t dt = currentTime - lastTime;
-
-			if (dt > CLOCKS_PER_SEC / FPS)
-			{
-				lastTime = currentTime;
-
-				UpdateGame(game, player, shields, NUM_SHIELDS, aliens);
-				ClearScreen();
-				DrawGame(game, player, shields, NUM_SHIELDS, aliens);
-				RefreshScreen();
-			}
-		}
-		else
+		if (strcmp(argv[i], "--autopilot") == 0)
 		{
-			quit = true;
+			autopilotOn = true;
+			continue; // the only option without a value
 		}
-	}
-	
-	CleanUpShields(shields, NUM_SHIELDS);
-	ShutdownCurses();
-
-	return 0;
-}
-
-void InitGame(Game& game)
-{
-	game.windowSize.width = ScreenWidth();
-	game.windowSize.height = ScreenHeight();
-	game.level = 1;
-	game.currentState = GS_PLAY; // TODO: change to GS_INTRO when we're done
-}
-
-void InitPlayer(const Game& game, Player& player)
-{
-	player.lives = MAX_NUMBER_LIVES;
-	player.spriteSize.width = PLAYER_SPRITE_WIDTH;
-	player.spriteSize.height = PLAYER_SPRITE_HEIGHT;
-	ResetPlayer(game, player);
-}
-
-void ResetPlayer(const Game& game, Player& player)
-{
-	player.position.x = game.windowSize.width / 2 - player.spriteSize.width / 2;
-	player.position.y = game.windowSize.height - player.spriteSize.height - 1;
 
-	player.animation = 0;
-	ResetMissile(player);
-}
+		const char* value = i + 1 < argc ? argv[i + 1] : NULL;
 
-void ResetMissile(Player& player)
-{
-	player.missile.x = NOT_IN_PLAY;
-	player.missile.y = NOT_IN_PLAY;
-}
-
-void ResetMovementTime(AlienSwarm& aliens)
-{
-	aliens.movementTime = aliens.line * 2 + (5 *
-		(float(aliens.numAliensLeft) / float(NUM_ALIEN_COLS * NUM_ALIEN_ROWS)));
-}
-
-int HandleInput(Game& game, Player& player)
-{
-	int input = GetChar();
-	switch (input)
-	{
-	case 'q':
-		return input;
-	case AK_LEFT:
-		if (game.currentState == GS_PLAY)
+		if (value == NULL)
 		{
-			MovePlayer(game, player, -PLAYER_MOVEMENT_AMOUNT);
+			break;
 		}
-		break;
-	case AK_RIGHT:
-		if (game.currentState == GS_PLAY)
+
+		if (strcmp(argv[i], "--replay") == 0)
 		{
-			MovePlayer(game, player, PLAYER_MOVEMENT_AMOUNT);
+			return RunReplay(value);
 		}
-		break;
-	case ' ':
-		if (game.currentState == GS_PLAY)
+		else if (strcmp(argv[i], "--record") == 0)
 		{
-			PlayerShoot(player);
+			recordFileName = value;
 		}
-		else if (game.currentState == GS_PLAYER_DEAD)
+		else if (strcmp(argv[i], "--save") == 0)
 		{
-			player.lives--;
-			player.animation = 0;
-			if (player.lives == 0)
-			{
-				game.currentState = GS_GAME_OVER;
-			}
-			else
-			{
-				game.currentState = GS_WAIT;
-				game.waitTimer = 10;
-			}
+			saveFileName = value;
 		}
-	}
-	
-	return input;
-}
-
-void UpdateGame(Game& game, Player& player, Shield shields[], int numberOfShields, AlienSwarm& aliens)
-{
-	if (game.currentState == GS_PLAY)
-	{
-		UpdateMissile(player);
-		Position shieldCollidePoint;
-
-		int shieldIndex = IsCollision(player.missile, shields, numberOfShields, shieldCollidePoint);
-
-		if (shieldIndex != NOT_IN_PLAY)
+		else if (strcmp(argv[i], "--resume") == 0)
 		{
-			ResetMissile(player);
-			ResolveShieldCollision(shields, shieldIndex, shieldCollidePoint);
+			resumeFileName = value;
 		}
-
-		Position playerAlienCollidePoint;
-		if (IsCollision(player, aliens, playerAlienCollidePoint))
+		else if (strcmp(argv[i], "--backend") == 0)
 		{
-			ResetMissile(player);
-			player.score += ResolveAlienCollision(aliens, playerAlienCollidePoint);
+			backend = strcmp(value, "ansi") == 0 ? OB_ANSI : OB_CURSES;
 		}
 
-		UpdateAliens(game, aliens, player, shields, numberOfShields);
+		i++;
 	}
-	else if (game.currentState == GS_PLAYER_DEAD)
-	{
-		player.animation = (player.animation + 1) % 2;
-	}
-	else if (game.currentState == GS_WAIT)
-	{
-		game.waitTimer--;
 
-		if (game.waitTimer == 0)
-		{
-			game.currentState = GS_PLAY;
-		}
-	}
-}
+	Simulation simulation;
 
-void DrawGame(const Game& game, const Player& player, Shield shields[], int numberOfShields, const AlienSwarm& aliens)
-{
-	if (game.currentState == GS_PLAY || game.currentState == GS_PLAYER_DEAD || game.currentState == GS_WAIT)
+	if (resumeFileName != NULL)
 	{
-		if (game.currentState == GS_PLAY || game.currentState == GS_WAIT)
+		// a replay is the inputs from a fresh game, so it can't start halfway through one
+		if (recordFileName != NULL)
 		{
-			DrawPlayer(player, PLAYER_SPRITE);
+			fprintf(stderr, "can't record a resumed game\n");
+			return 1;
 		}
-		else
+
+		if (!LoadGameWorld(simulation.world, resumeFileName))
 		{
-			DrawPlayer(player, PLAYER_EXPLOSION_SPRITE);
+			fprintf(stderr, "could not read saved game %s\n", resumeFileName);
+			return 1;
 		}
-		
-		DrawShields(shields, numberOfShields);
-		DrawAliens(aliens);
-	}
-	
-}
-
-void MovePlayer(const Game& game, Player& player, int dx)
-{
-	if (player.position.x + player.spriteSize.width + dx > game.windowSize.width)
-	{
-		player.position.x = game.windowSize.width - player.spriteSize.width; // rightmost position
-	}
-	else if (player.position.x + dx < 0)
-	{
-		player.position.x = 0;
-	}
-	else
-	{
-		player.position.x += dx;
-	}
-}
-
-void PlayerShoot(Player& player)
-{
-	if (player.missile.x == NOT_IN_PLAY || player.missile.y == NOT_IN_PLAY)
-	{
-		player.missile.y = player.position.y - 1; //one row above the player
-		player.missile.x = player.position.x + player.spriteSize.width / 2;
 	}
-}
 
-void DrawPlayer(const Player& player, const char* sprite[])
-{
-	DrawSprite(player.position.x, player.position.y, PLAYER_SPRITE, player.spriteSize.height);
+	InitializeCurses(false, backend);
 
-	if (player.missile.x != NOT_IN_PLAY)
-	{
-		DrawCharacter(player.missile.x, player.missile.y, PLAYER_MISSILE_SPRITE);
-	}
-}
+	// a resumed game keeps the board it was saved with, so the terminal has to be at least that big
+	Size boardSize = { ScreenWidth(), ScreenHeight() };
+	uint64_t seed = uint64_t(time(NULL));
 
-void UpdateMissile(Player& player)
-{
-	if (player.missile.y != NOT_IN_PLAY)
+	if (resumeFileName != NULL)
 	{
-		player.missile.y -= PLAYER_MISSILE_SPEED;
+		Size savedSize = simulation.world.game.windowSize;
 
-		if (player.missile.y < 0)
+		if (savedSize.width > boardSize.width || savedSize.height > boardSize.height)
 		{
-			ResetMissile(player);
+			ShutdownCurses();
+			fprintf(stderr, "%s was saved on a %dx%d board, the terminal is only %dx%d\n", resumeFileName,
+				savedSize.width, savedSize.height, boardSize.width, boardSize.height);
+			return 1;
 		}
-	}
-}
 
-bool UpdateAliens(const Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields)
-{
-	if (UpdateBombs(game, aliens, player, shields, numberOfShields))
-	{
-		return true;
+		boardSize = savedSize;
 	}
-
-	if (aliens.explosionTimer >= 0)
+	else
 	{
-		aliens.explosionTimer--; // even if explosion timer is zero, it'll go to NOT_IN_PLAY
+		InitGameWorld(simulation.world, boardSize, seed);
 	}
 
-	for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-	{
-		for (int col = 0; col < NUM_ALIEN_COLS; col++)
-		{
-			if (aliens.aliens[row][col] == AS_EXPLODING && aliens.explosionTimer == NOT_IN_PLAY)
-			{
-				aliens.aliens[row][col] = AS_DEAD;
-			}
-		}
-	}
+	StartRecording(simulation.replay, seed, boardSize); // cheap enough to always do, we only save it if asked to
 
-	aliens.movementTime--;
+	InitTripleBuffer(simulation.snapshots);
+	WriteBuffer(simulation.snapshots) = simulation.world;
+	PublishWriteBuffer(simulation.snapshots);
 
-	bool moveHorizontal = 0 >= aliens.movementTime;
-	int emptyColsLeft = 0;
-	int emptyColsRight = 0;
-	int emptyRowsBottom = 0;
+	InitQueue(simulation.inputs);
+	simulation.stopping = false;
+	simulation.autopilotOn = autopilotOn;
+	InitAutopilot(simulation.autopilot, seed);
+	StartThreadPool(simulation.pool);
+	simulation.startTime = steady_clock::now();
 
-	FindEmptyRowsAndColumns(aliens, emptyColsLeft, emptyColsRight, emptyRowsBottom);
+	int lastFrameDrawn = simulation.world.game.stats.frames; // the world is the simulation thread's once it starts
 
-	int numberOfColumns = NUM_ALIEN_COLS - emptyColsLeft - emptyColsRight;
-	int leftAlienPosition = aliens.position.x + emptyColsLeft * (aliens.spriteSize.width + ALIENS_X_PADDING);
-	int rightAlienPosition = leftAlienPosition + numberOfColumns * aliens.spriteSize.width + (numberOfColumns - 1) * ALIENS_X_PADDING;
+	std::thread simulationThread(RunSimulation, std::ref(simulation));
 
-	if (((rightAlienPosition >= game.windowSize.width && aliens.direction > 0) ||
-		(leftAlienPosition <= 0 && aliens.direction < 0)) && 
-		moveHorizontal && 
-		aliens.line > 0)
-	{
-		//move down position
-		moveHorizontal = false;
-		aliens.position.y++;
-		aliens.line--;
-		aliens.direction = -aliens.direction;
-		ResetMovementTime(aliens);
-		DestroyShields(aliens, shields, numberOfShields);
-	}
+	Renderer renderer;
+	InitRenderer(renderer, boardSize.width, boardSize.height);
 
-	if (moveHorizontal)
-	{
-		aliens.position.x += aliens.direction;
-		ResetMovementTime(aliens);
-		aliens.animation = aliens.animation == 0 ? 1 : 0;
-		DestroyShields(aliens, shields, numberOfShields);
-	}
+	bool quit = false;
+	bool needsDraw = true;
+	int input;
+	int gameInput = GI_NONE;
+
+	PerformanceHud hud; // 'h' shows it
+	InitPerformanceHud(hud, Microseconds(steady_clock::now()));
 
-	if (!moveHorizontal)
+	// the simulation runs on its own thread, this one draws the latest snapshot whenever there is a new one
+	// and passes the keys on, so a terminal that is slow to take our output slows the drawing down but not the game
+	while (!quit)
 	{
-		int activeColumns[NUM_ALIEN_COLS];
+		steady_clock::time_point frameStartTime = steady_clock::now();
 
-		int numActiveCols = 0;
-		for (int c = emptyColsLeft; c < numberOfColumns; ++c)
+		if (ReadLatest(simulation.snapshots))
 		{
-			for (int r = 0; r < NUM_ALIEN_ROWS; r++)
-			{
-				if (aliens.aliens[r][c] == AS_ALIVE)
-				{
-					activeColumns[numActiveCols] = c;
-					numActiveCols++;
-					break;
-				}
-			}
+			const GameWorld& snapshot = ReadBuffer(simulation.snapshots);
+			RecordHudTicks(hud, snapshot.game.stats.frames - lastFrameDrawn, snapshot);
+			lastFrameDrawn = snapshot.game.stats.frames;
+			needsDraw = true;
 		}
 
-		if (ShouldShootBomb(aliens))
+		if (needsDraw)
 		{
-			if (numActiveCols > 0)
-			{
-				int numberOfShots = ((rand() % 3) + 1) - aliens.numberOfBombsInPlay;
+			const GameWorld& snapshot = ReadBuffer(simulation.snapshots);
 
-				for (int i = 0; i < numberOfShots; i++)
-				{
-					int columnToShoot = rand() % numActiveCols;
-					ShootBomb(aliens, columnToShoot);
-				}
-			}
-		}
-	}
-
-	return false;
-}
+			BeginFrame(renderer);
+			DrawGame(renderer, snapshot.game, snapshot.player, snapshot.shields, NUM_SHIELDS, snapshot.aliens);
+			DrawPerformanceHud(renderer, hud, snapshot);
 
-void FindEmptyRowsAndColumns(const AlienSwarm& aliens, int& emptyColsLeft, int& emptyColsRight, int& emptyRowsBottom)
-{
-	
-	// check each column, starting at the left side
-	bool found = false;
-	for (int col = 0; col < NUM_ALIEN_COLS && !found; ++col)
-	{
-		for (int row = 0; row < NUM_ALIEN_ROWS && !found; ++row)
-		{
-			if ((aliens.aliens[row][col] == AS_DEAD))
+			if (simulation.autopilotOn)
 			{
-				if (row == NUM_ALIEN_ROWS - 1) // last row
-				{
-					emptyColsLeft++;
-				}
-				
-			}
-			else
-			{
-				found = true;
+				const char label[] = " autopilot, a takes over ";
+				RenderString(renderer, renderer.width - int(sizeof(label) - 1), 0, label, int(sizeof(label) - 1));
 			}
+
+			steady_clock::time_point flushTime = steady_clock::now();
+			PresentFrame(renderer);
+			steady_clock::time_point frameEndTime = steady_clock::now();
+
+			RecordHudFrame(hud, int(Microseconds(frameEndTime) - Microseconds(frameStartTime)),
+				int(Microseconds(frameEndTime) - Microseconds(flushTime)), renderer.bytesLastFrame, Microseconds(frameEndTime));
+			needsDraw = false;
 		}
-	}
 
-	// check each column, starting at the right side
-	found = false;
+		// wait for a key until just after the simulation's next tick is due
+		steady_clock::duration sinceStart = steady_clock::now() - simulation.startTime;
+		steady_clock::time_point nextTickTime = simulation.startTime + (sinceStart / TickDuration() + 1) * TickDuration();
+		int timeoutMilliseconds = std::max(0, int(ceil<milliseconds>(nextTickTime - steady_clock::now()).count()) + 1);
 
-	for (int col = NUM_ALIEN_COLS - 1; col >= 0 && !found; col--)
-	{
-		for (int row = 0; row < NUM_ALIEN_ROWS && !found; row++)
 		{
-			if (aliens.aliens[row][col] == AS_DEAD)
-			{
-				if (row == NUM_ALIEN_ROWS - 1)
-				{
-					emptyColsRight++;
-				}
-			}
-			else
-			{
-				found = true;
-			}
+			PROFILE_SCOPE("InputAndWait"); // mostly the sleep until the next tick
+			input = HandleInput(gameInput, timeoutMilliseconds);
 		}
-	}
 
-	//check each row, starting at the bottom
-	found = false;
-	for (int row = NUM_ALIEN_ROWS - 1; row >= 0 && !found; row--)
-	{
-		for (int col = 0; col < NUM_ALIEN_COLS && !found; col++)
+		if (gameInput != GI_NONE)
 		{
-			if (aliens.aliens[row][col] == AS_DEAD)
-			{
-				if (col == NUM_ALIEN_COLS - 1)
-				{
-					emptyRowsBottom++;
-				}
-			}
-			else
-			{
-				found = true;
-			}
+			PushItem(simulation.inputs, gameInput); // if the simulation is that far behind, dropping the key is fine
+			gameInput = GI_NONE;
 		}
-	}
-}
 
-void CollideShieldsWithAlien(Shield shields[], int numberOfShields, int alienX, int alienY, const Size& size)
-{
-	for (int s = 0; s < numberOfShields; s++)
-	{
-		Shield& shield = shields[s];
-
-		if (alienX < shield.position.x + SHIELD_SPRITE_WIDTH && 
-			alienX + size.width >= shield.position.x &&
-			alienY < shield.position.y + SHIELD_SPRITE_HEIGHT &&
-			alienY + size.height >= shield.position.y)
+		if (input == 'q')
 		{
-			// we are colliding
-
-			int dy = alienY - shield.position.y;
-			int dx = alienX - shield.position.x;
-
-			for (int h = 0; h < size.height; h++) // check height
-			{
-				int shieldY = dy + h;
-				if (shieldY >= 0 && shieldY < SHIELD_SPRITE_HEIGHT)
-				{
-					for (int w = 0; w < size.width; w++) // check width
-					{
-						int shieldX = dx + w;
-
-						if (shieldX >= 0 && shieldX < SHIELD_SPRITE_WIDTH)
-						{
-							shield.sprite[shieldY][shieldX] = ' ';
-						}
-					}
-				}
-			}
-
-			break;
-
+			quit = true;
 		}
-	}
-}
-
-void InitShields(const Game& game, Shield shields[], int numberOfShields)
-{
-	int firstPadding = ceil(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH)/float(numberOfShields+1));
-	int xPadding = floor(float(game.windowSize.width - numberOfShields * SHIELD_SPRITE_WIDTH) / float(numberOfShields + 1));
-
-	for (int i = 0; i < numberOfShields; i++)
-	{
-		Shield& shield = shields[i];
-		shield.position.x = firstPadding + i * (SHIELD_SPRITE_WIDTH + xPadding);
-		shield.position.y = game.windowSize.height - PLAYER_SPRITE_HEIGHT - 1 - SHIELD_SPRITE_HEIGHT - 2;
-
-		for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++)
+		else if (input == 'h')
 		{
-			shield.sprite[row] = new char[SHIELD_SPRITE_WIDTH + 1];
-			strcpy_s(shield.sprite[row], SHIELD_SPRITE_WIDTH + 1, SHIELD_SPRITE[row]);
+			hud.visible = !hud.visible;
+			needsDraw = true;
 		}
-	}
-}
-
-void CleanUpShields(Shield shields[], int numberOfShields)
-{
-	for (int i = 0; i < numberOfShields; i++)
-	{
-		Shield& shield = shields[i];
-
-		for (int row = 0; row < SHIELD_SPRITE_HEIGHT; row++) 
+		else if (input == 'a')
 		{
-			delete[] shield.sprite[row];
+			simulation.autopilotOn = !simulation.autopilotOn;
+			needsDraw = true;
 		}
+#ifdef TEXTINVADERS_PROFILE
+		else if (input == 'p')
+		{
+			SaveProfile();
+		}
+#endif
 	}
-}
 
-bool ShouldShootBomb(const AlienSwarm& aliens)
-{
-	return int(rand() % (70 - int(float(NUM_ALIEN_ROWS * NUM_ALIEN_COLS) / 
-								  float(aliens.numAliensLeft+1)))) == 1;
-}
+	simulation.stopping = true;
+	simulationThread.join();
+	StopThreadPool(simulation.pool);
+	
+	ShutdownCurses();
 
-void ShootBomb(AlienSwarm& aliens, int columnToShoot)
-{
-	int bombId = NOT_IN_PLAY;
+#ifdef TEXTINVADERS_PROFILE
+	SaveProfile();
+	WriteProfileSummary(stderr);
+#endif
 
-	for (int i = 0; i < MAX_NUMBER_ALIEN_BOMBS; i++)
+	if (saveFileName != NULL && !SaveGameWorld(simulation.world, saveFileName))
 	{
-		if (aliens.bombs[i].position.x == NOT_IN_PLAY || aliens.bombs[i].position.y == NOT_IN_PLAY)
-		{
-			bombId = i;
-			break;
-		}
+		fprintf(stderr, "could not write saved game %s\n", saveFileName);
+		return 1;
 	}
 
-	for (int r = NUM_ALIEN_ROWS - 1; r >= 0; r--)
+	if (recordFileName != NULL)
 	{
-		if (aliens.aliens[r][columnToShoot] == AS_ALIVE)
+		FinishRecording(simulation.replay, simulation.world);
+
+		if (!SaveReplay(simulation.replay, recordFileName))
 		{
-			int x = aliens.position.x + columnToShoot * 
-				(aliens.spriteSize.width + ALIENS_X_PADDING) + 1; // roughly middle of the alien
-			int y = aliens.position.y + r * 
-				(aliens.spriteSize.height + ALIENS_Y_PADDING) + aliens.spriteSize.height; // bottom of alien
-
-			aliens.bombs[bombId].animation = 0;
-			aliens.bombs[bombId].position.x = x;
-			aliens.bombs[bombId].position.y = y;
-			
-			aliens.numberOfBombsInPlay++;
-			
-			break;
+			fprintf(stderr, "could not write replay %s\n", recordFileName);
+			return 1;
 		}
 	}
+
+	return 0;
 }
 
-bool UpdateBombs(const Game& game, AlienSwarm& aliens, Player& player, Shield shields[], int numberOfShields)
+// plays a recorded game back with no rendering and no frame pacing, and checks it ends the same way
+int RunReplay(const char* fileName)
 {
-	int numBombSprites = strlen(ALIEN_BOMB_SPRITE);
+	Replay replay;
 
-	for (int i = 0; i < MAX_NUMBER_ALIEN_BOMBS; i++)
+	if (!LoadReplay(replay, fileName))
 	{
-		if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
-		{
-			aliens.bombs[i].position.y += ALIEN_BOMB_SPEED;
-			aliens.bombs[i].animation = (aliens.bombs[i].animation + 1) % numBombSprites;
-
-			Position collisionPoint;
-			int shieldIndex= IsCollision(aliens.bombs[i].position, shields, numberOfShields, collisionPoint);
-
-			if (shieldIndex != NOT_IN_PLAY)
-			{
-				aliens.bombs[i].position.x = NOT_IN_PLAY;
-				aliens.bombs[i].position.y = NOT_IN_PLAY;
-				aliens.bombs[i].animation = 0;
-				aliens.numberOfBombsInPlay--;
-				ResolveShieldCollision(shields, shieldIndex, collisionPoint);
-			}
-			else if (IsCollision(aliens.bombs[i].position, player.position, player.spriteSize))
-			{
-				aliens.bombs[i].position.x = NOT_IN_PLAY;
-				aliens.bombs[i].position.y = NOT_IN_PLAY;
-				aliens.bombs[i].animation = 0;
-				aliens.numberOfBombsInPlay--;
-				return true;
-			}
-			else if (aliens.bombs[i].position.y >= game.windowSize.height)
-			{
-				aliens.bombs[i].position.x = NOT_IN_PLAY;
-				aliens.bombs[i].position.y = NOT_IN_PLAY;
-				aliens.bombs[i].animation = 0;
-				aliens.numberOfBombsInPlay--;
-			}
-		}
+		fprintf(stderr, "could not read replay %s\n", fileName);
+		return 1;
 	}
-}
 
+	GameWorld world;
 
-void DrawShields(const Shield shields[], int numberOfShields)
-{
-for (int i = 0; i < numberOfShields; i++)
-{
-	const Shield shield = shields[i];
+	steady_clock::time_point startTime = steady_clock::now();
+	bool matches = PlayReplay(replay, world);
+	double milliseconds = duration<double, std::milli>(steady_clock::now() - startTime).count();
 
-	DrawSprite(shield.position.x, shield.position.y, (const char**)shield.sprite, SHIELD_SPRITE_HEIGHT);
-}
+	printf("%s: %d ticks in %.2f ms, score %d, hash %016llx: %s\n", fileName, replay.numberOfTicks, milliseconds,
+		world.player.score, (unsigned long long)HashGameWorld(world), matches ? "matches" : "DOES NOT MATCH");
+
+	return matches ? 0 : 1;
 }
 
-int IsCollision(const Position& projectile, const Shield shields[], int numberOfShields, Position& shieldCollidePoint)
+#ifdef TEXTINVADERS_PROFILE
+void SaveProfile()
 {
-	shieldCollidePoint.x = NOT_IN_PLAY;
-	shieldCollidePoint.y = NOT_IN_PLAY;
+	WriteChromeTrace(PROFILE_TRACE_FILE);
 
-	if (projectile.y != NOT_IN_PLAY)
+	FILE* summaryFile = fopen(PROFILE_SUMMARY_FILE, "w");
+	if (summaryFile != NULL)
 	{
-		for (int i = 0; i < numberOfShields; i++)
-		{
-			const Shield& shield = shields[i];
-
-			if (
-				// if the projectile is within the shield's x boundaries
-				projectile.x >= shield.position.x && projectile.x < (shield.position.x + SHIELD_SPRITE_WIDTH) &&
-				// and within the y boundaries
-				projectile.y >= shield.position.y && projectile.y < (shield.position.y + SHIELD_SPRITE_HEIGHT) &&
-				// and the character there isn't a space char
-				shield.sprite[projectile.y - shield.position.y][projectile.x - shield.position.x] != ' '
-				)
-			{
-				// then there's a collision
-				shieldCollidePoint.x = projectile.x - shield.position.x;
-				shieldCollidePoint.y = projectile.y - shield.position.y;
-				return i;
-			}
-		}
+		WriteProfileSummary(summaryFile);
+		fclose(summaryFile);
 	}
-
-	return NOT_IN_PLAY;
 }
+#endif
 
-bool IsCollision(const Player& player, const AlienSwarm& aliens, Position& alienCollidePositionInArray)
+// fixed timestep: the world always advances in ticks of 1/FPS of wall clock time
+void RunSimulation(Simulation& simulation)
 {
-	alienCollidePositionInArray.x = NOT_IN_PLAY;
-	alienCollidePositionInArray.y = NOT_IN_PLAY;
+	steady_clock::time_point nextTickTime = simulation.startTime + TickDuration();
+	int autopilotInput = GI_NONE; // for the coming tick, chosen while waiting for it
 
-	for (int row = 0; row < NUM_ALIEN_ROWS; row++)
+	while (!simulation.stopping)
 	{
-		for (int col = 0; col < NUM_ALIEN_COLS; col++)
-		{
-			int x = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-			int y = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING);
+		std::this_thread::sleep_until(nextTickTime);
 
-			if (aliens.aliens[row][col] == AS_ALIVE &&
-				player.missile.x >= x && player.missile.x < x + aliens.spriteSize.width &&
-				player.missile.y >= y && player.missile.y < y + aliens.spriteSize.height)
-			{
-				alienCollidePositionInArray.x = col;
-				alienCollidePositionInArray.y = row;
-				return true;
-			}
+		int gameInput = GI_NONE;
+		int queuedInput;
+		while (PopItem(simulation.inputs, queuedInput))
+		{
+			gameInput |= queuedInput;
 		}
-	}
 
-	return false;
-}
+		if (simulation.autopilotOn)
+		{
+			gameInput = autopilotInput; // the keys still have to be taken off the queue, or they'd all land when it's turned off
+		}
 
-bool IsCollision(const Position& projectile, const Position& spritePosition, const Size& spriteSize)
-{
-	return (projectile.x >= spritePosition.x && projectile.x < (spritePosition.x + spriteSize.width) &&
-		projectile.y >= spritePosition.y && projectile.y < (spritePosition.y + spriteSize.height));
-}
+		StepGameWorld(simulation.world, gameInput);
+		RecordTick(simulation.replay, gameInput);
 
-void ResolveShieldCollision(Shield shields[], int shieldIndex, const Position& shieldCollidePoint)
-{
-	shields[shieldIndex].sprite[shieldCollidePoint.y][shieldCollidePoint.x] = ' ';
-}
+		WriteBuffer(simulation.snapshots) = simulation.world;
+		PublishWriteBuffer(simulation.snapshots);
 
-int ResolveAlienCollision(AlienSwarm& aliens, const Position& hitPositionInAliensArray)
-{
-	aliens.aliens[hitPositionInAliensArray.y][hitPositionInAliensArray.x] = AS_EXPLODING;
-	aliens.numAliensLeft--;
+		nextTickTime += TickDuration();
 
-	if (aliens.explosionTimer == NOT_IN_PLAY)
-	{
-		aliens.explosionTimer = ALIENS_EXPLOSION_TIME;
-	}
+		if (steady_clock::now() - nextTickTime > MAX_TICKS_PER_FRAME * TickDuration())
+		{
+			nextTickTime = steady_clock::now(); // we stalled, drop the backlog instead of fast forwarding
+		}
 
-	if (hitPositionInAliensArray.y == 0)
-	{
-		return 30;
-	}
-	else if (hitPositionInAliensArray.y >= 1 && hitPositionInAliensArray.y < 3)
-	{
-		return 20;
-	}
-	else
-	{
-		return 10;
+		// the rest of the wait is the autopilot's to think in, whatever it hasn't finished by then is dropped
+		autopilotInput = simulation.autopilotOn ? ChooseAutopilotInput(simulation.autopilot, simulation.world, &simulation.pool, nextTickTime) : GI_NONE;
 	}
 }
 
-void DestroyShields(const AlienSwarm& aliens, Shield shields[], int numberOfShields)
+steady_clock::duration TickDuration()
 {
-	for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-	{
-		for (int col = 0; col < NUM_ALIEN_COLS; col++)
-		{
-			if (aliens.aliens[row][col] == AS_ALIVE)
-			{
-				int x = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-				int y = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING);
-
-				CollideShieldsWithAlien(shields, numberOfShields, x, y, aliens.spriteSize);
-			}
-		}
-	}
+	return duration_cast<steady_clock::duration>(seconds(1)) / FPS;
 }
 
-void InitAliens(const Game& game, AlienSwarm& aliens)
+int64_t Microseconds(steady_clock::time_point time)
 {
-	for (int row = 0; row < NUM_ALIEN_ROWS; row++)
-	{
-		for (int col = 0; col < NUM_ALIEN_COLS; col++)
-		{
-			aliens.aliens[row][col] = AS_ALIVE;
-		}
-	}
-
-	ResetMovementTime(aliens);
-
-	aliens.direction = 1; // going to the right
-	aliens.numAliensLeft = NUM_ALIEN_ROWS * NUM_ALIEN_COLS;
-	aliens.animation = 0;
-	aliens.spriteSize.width = ALIEN_SPRITE_WIDTH;
-	aliens.spriteSize.height = ALIEN_SPRITE_HEIGHT;
-	aliens.numberOfBombsInPlay = 0;
-	aliens.position.x = (game.windowSize.width - NUM_ALIEN_COLS * (aliens.spriteSize.width + ALIENS_X_PADDING))/2;
-	aliens.position.y = game.windowSize.height - NUM_ALIEN_COLS -
-		NUM_ALIEN_ROWS * aliens.spriteSize.height - ALIENS_Y_PADDING * (NUM_ALIEN_ROWS - 1) - 3 + game.level;
-	aliens.line = NUM_ALIEN_COLS - (game.level - 1);
-	aliens.explosionTimer = NOT_IN_PLAY;
-
-	for (int i = 0; i < MAX_NUMBER_ALIEN_BOMBS; i++)
-	{
-		aliens.bombs[i].animation = 0;
-		aliens.bombs[i].position.x = NOT_IN_PLAY;
-		aliens.bombs[i].position.y = NOT_IN_PLAY;
-	}
+	return duration_cast<microseconds>(time.time_since_epoch()).count();
 }
 
-void DrawAliens(const AlienSwarm& aliens)
+int HandleInput(int& gameInput, int timeoutMilliseconds)
 {
-	const int NUM_30_POINT_ALIEN_ROWS = 1;
-	// draw one row of 30 point aliens
-	for (int col = 0; col < NUM_ALIEN_COLS; col++)
-	{
-		int x = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-		int y = aliens.position.y;
-
-		if (aliens.aliens[0][col] == AS_ALIVE)
-		{
-			DrawSprite(x, y, ALIEN30_SPRITE, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
-		}
-		else if (aliens.aliens[0][col] == AS_EXPLODING)
-		{
-			DrawSprite(x, y, ALIEN_EXPLOSION, aliens.spriteSize.height);
-		}
-	}
-
-	// draw two rows of 20 point aliens
-	const int NUM_20_POINT_ALIEN_ROWS = 2;
-	for (int row = 0; row < NUM_20_POINT_ALIEN_ROWS; row++)
-	{
-		for (int col = 0; col < NUM_ALIEN_COLS; col++)
-		{
-			int x = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-			int y = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING) + 
-				NUM_30_POINT_ALIEN_ROWS * (aliens.spriteSize.height + ALIENS_Y_PADDING);
-
-			if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + row][col] == AS_ALIVE)
-			{
-				DrawSprite(x, y, ALIEN20_SPRITE, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
-			}
-			else if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + row][col] == AS_EXPLODING)
-			{
-				DrawSprite(x, y, ALIEN_EXPLOSION, aliens.spriteSize.height);
-			}
-		}
-	}
-	// draw two rows of 10 point aliens
-	const int NUM_10_POINT_ALIEN_ROWS = 2;
-	for (int row = 0; row < NUM_10_POINT_ALIEN_ROWS; row++)
-	{
-		for (int col = 0; col < NUM_ALIEN_COLS; col++)
-		{
-			int x = aliens.position.x + col * (aliens.spriteSize.width + ALIENS_X_PADDING);
-			int y = aliens.position.y + row * (aliens.spriteSize.height + ALIENS_Y_PADDING) +
-				NUM_30_POINT_ALIEN_ROWS * (aliens.spriteSize.height + ALIENS_Y_PADDING) +
-				NUM_20_POINT_ALIEN_ROWS * (aliens.spriteSize.height + ALIENS_Y_PADDING);
-
-			if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + NUM_20_POINT_ALIEN_ROWS + row][col] == AS_ALIVE)
-			{
-				DrawSprite(x, y, ALIEN10_SPRITE, aliens.spriteSize.height, aliens.animation * aliens.spriteSize.height);
-			}
-			else if (aliens.aliens[NUM_30_POINT_ALIEN_ROWS + NUM_20_POINT_ALIEN_ROWS + row][col] == AS_EXPLODING)
-			{
-				DrawSprite(x, y, ALIEN_EXPLOSION, aliens.spriteSize.height);
-			}
-		}
-	}
-
-	if (aliens.numberOfBombsInPlay > 0)
+	int input = GetCharTimeout(timeoutMilliseconds);
+	switch (input)
 	{
-		for (int i = 0; i < MAX_NUMBER_ALIEN_BOMBS; i++)
-		{
-			if (aliens.bombs[i].position.x != NOT_IN_PLAY && aliens.bombs[i].position.y != NOT_IN_PLAY)
-			{
-				DrawCharacter(aliens.bombs[i].position.x, aliens.bombs[i].position.y, 
-					ALIEN_BOMB_SPRITE[aliens.bombs[i].animation]);
-			}
-		}
+	case AK_LEFT:
+		gameInput |= GI_LEFT;
+		break;
+	case AK_RIGHT:
+		gameInput |= GI_RIGHT;
+		break;
+	case ' ':
+		gameInput |= GI_FIRE;
+		break;
 	}
-}
+	
+	return input;
+}
\ No newline at end of file
@@ -1,48 +1,68 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "BitUtils.h"
+#include "ProjectilePool.h"
+#include "SwarmLayout.h"
+#include "Sprite.h"
+#include "Random.h"
+#include "TimerWheel.h"
 
-const char* PLAYER_SPRITE[] = { " /A\\ ", "|/V\\|" };
+// every sprite's size comes from its strings, MakeSprite checks they agree
+constexpr auto PLAYER_SPRITE = MakeSprite<1>(" /A\\ ", "|/V\\|");
 
-const char* PLAYER_EXPLOSION_SPRITE[] = { " |@/.", ".`//-", "`_~; ", "_~`\"." };
+constexpr auto PLAYER_EXPLOSION_SPRITE = MakeSprite<2>(" |@/.", ".`//-", "`_~; ", "_~`\".");
 
-const char PLAYER_MISSILE_SPRITE = '!';
+constexpr auto PLAYER_MISSILE_SPRITE = MakeSprite<1>("!");
 
-const char* SHIELD_SPRITE[] = {"/IIIII\\", "IIIIIII", "I/   \\I"};
+constexpr auto SHIELD_SPRITE = MakeSprite<1>("/IIIII\\", "IIIIIII", "I/   \\I");
 
-const char* ALIEN30_SPRITE[] = { "/oO\\", "/\"\"\\", "/Oo\\", "<''>" };
+constexpr auto ALIEN30_SPRITE = MakeSprite<2>("/oO\\", "/\"\"\\", "/Oo\\", "<''>");
 
-const char* ALIEN20_SPRITE[] = { " >< ", "|\\/|", "|><|", "/  \\" };
+constexpr auto ALIEN20_SPRITE = MakeSprite<2>(" >< ", "|\\/|", "|><|", "/  \\");
 
-const char* ALIEN10_SPRITE[] = { "/--\\", "/  \\", "/--\\", "<  >" };
+constexpr auto ALIEN10_SPRITE = MakeSprite<2>("/--\\", "/  \\", "/--\\", "<  >");
 
-const char* ALIEN_EXPLOSION[] = { "\\||/", "/|\\*" };
+constexpr auto ALIEN_EXPLOSION = MakeSprite<1>("\\||/", "/|\\*");
 
-const char* ALIEN_BOMB_SPRITE = "\\|/-";
+constexpr auto ALIEN_BOMB_SPRITE = MakeSprite<4>("\\", "|", "/", "-");
 
 enum
 {
-	SHIELD_SPRITE_HEIGHT = 3,
-	SHIELD_SPRITE_WIDTH = 7,
+	SHIELD_SPRITE_HEIGHT = SHIELD_SPRITE.SPRITE_HEIGHT,
+	SHIELD_SPRITE_WIDTH = SHIELD_SPRITE.SPRITE_WIDTH,
 	NUM_ALIEN_ROWS = 5,
 	NUM_ALIEN_COLS = 11,
 	MAX_NUMBER_ALIEN_BOMBS = 3,
 	MAX_NUMBER_LIVES = 3,
-	PLAYER_SPRITE_WIDTH = 5,
-	PLAYER_SPRITE_HEIGHT = 2,
+	PLAYER_SPRITE_WIDTH = PLAYER_SPRITE.SPRITE_WIDTH,
+	PLAYER_SPRITE_HEIGHT = PLAYER_SPRITE.SPRITE_HEIGHT,
 	NOT_IN_PLAY = -1,
 	PLAYER_MOVEMENT_AMOUNT = 1,
 	PLAYER_MISSILE_SPEED = 1,
 	FPS = 30,
+	MAX_TICKS_PER_FRAME = 5, // cap on catch-up ticks after a stall
 	NUM_SHIELDS = 4,
-	ALIEN_SPRITE_WIDTH = 4,
-	ALIEN_SPRITE_HEIGHT = 2,
+	ALIEN_SPRITE_WIDTH = ALIEN30_SPRITE.SPRITE_WIDTH,
+	ALIEN_SPRITE_HEIGHT = ALIEN30_SPRITE.SPRITE_HEIGHT,
 	ALIENS_X_PADDING = 1,
 	ALIENS_Y_PADDING = 1,
 	ALIENS_EXPLOSION_TIME = 4,
-	ALIEN_BOMB_SPEED = 1
+	ALIEN_BOMB_SPEED = 1,
+	RESPAWN_WAIT_TIME = 10,
+	MAX_GAME_TIMERS = 16, // the swarm's next step, the next volley, a respawn and each explosion, with room to spare
+	MAX_BOARD_SIZE = 1 << 16 // bigger than any terminal, small enough that nothing on the board overflows, for boards read from files
 };
 
+typedef Sprite<ALIEN_SPRITE_WIDTH, ALIEN_SPRITE_HEIGHT, 2> AlienSprite; // every kind of alien has to be the same size, with two frames
+
+constexpr const AlienSprite* ALIEN_SPRITES[NUM_ALIEN_TYPES] = { &ALIEN30_SPRITE, &ALIEN20_SPRITE, &ALIEN10_SPRITE }; // by AlienType
+
+static_assert(int(ALIEN_EXPLOSION.SPRITE_WIDTH) == ALIEN_SPRITE_WIDTH && int(ALIEN_EXPLOSION.SPRITE_HEIGHT) == ALIEN_SPRITE_HEIGHT, "an explosion has to cover the alien");
+
+// the swarm the game is played with
+typedef SwarmLayout<NUM_ALIEN_ROWS, NUM_ALIEN_COLS, ALIEN_SPRITE_WIDTH, ALIEN_SPRITE_HEIGHT, ALIENS_X_PADDING, ALIENS_Y_PADDING> ClassicSwarmLayout;
+
 enum AlienState
 {
 	AS_ALIVE = 0,
@@ -85,30 +105,36 @@ struct Player
 struct Shield
 {
 	Position position;
-	char* sprite[SHIELD_SPRITE_HEIGHT];
+	Bitmask rows[SHIELD_SPRITE_HEIGHT]; // bit x is set where the shield is still standing, the glyphs come from SHIELD_SPRITE
 };
 
-struct AlienBomb
+// a swarm of any SwarmLayout, the positions of its rows and columns come from the layout's tables
+template<class LAYOUT>
+struct BasicAlienSwarm
 {
-	Position position;
-	int animation;
-};
+	typedef LAYOUT Layout;
 
-struct AlienSwarm
-{
 	Position position;
-	AlienState aliens[NUM_ALIEN_ROWS][NUM_ALIEN_COLS];
-	AlienBomb bombs[MAX_NUMBER_ALIEN_BOMBS];
-	Size spriteSize;
+	// an alien is dead when its bit is set in neither the alive nor the exploding masks
+	Bitmask aliveInRow[LAYOUT::NUM_ROWS]; // bit col is set for each living alien in the row
+	Bitmask explodingInRow[LAYOUT::NUM_ROWS];
+	Bitmask aliveInColumn[LAYOUT::NUM_COLS]; // bit row is set for each living alien in the column
+	Bitmask explodingInColumn[LAYOUT::NUM_COLS];
+	Bitmask occupiedColumns; // bit col is set if any alien in the column is alive or exploding
+	Bitmask occupiedRows; // bit row is set if any alien in the row is alive or exploding
+	int lowestAlienInColumn[LAYOUT::NUM_COLS]; // row of the lowest living alien in each column, NOT_IN_PLAY if there is none
+	int shooterColumns[LAYOUT::NUM_COLS]; // the columns that still have a living alien, in no particular order
+	int shooterColumnIndex[LAYOUT::NUM_COLS]; // where each column is in shooterColumns, NOT_IN_PLAY if it isn't
+	int numberOfShooterColumns;
+	ProjectilePool<MAX_NUMBER_ALIEN_BOMBS> bombs;
 	int animation;
 	int direction; // >0 - for going right, <0 - for going left
-	int numberOfBombsInPlay;
-	int movementTime; // capture how fast the aliens should be going
-	int explosionTimer; // capture how long to explode for
 	int numAliensLeft; // capture when to go to next level
 	int line; // capture when the aliens win starts at current level and decreases to zero
 };
 
+typedef BasicAlienSwarm<ClassicSwarmLayout> AlienSwarm;
+
 struct AlienUFO
 {
 	Position position;
@@ -127,10 +153,21 @@ struct HighScoreTable
 	std::vector<Score> scores;
 };
 
+// running totals for balancing and batch runs, they don't affect the game
+struct GameStats
+{
+	int frames;
+	int bombsFired;
+	int shieldCellsDestroyed;
+	int playerHits;
+};
+
 struct Game
 {
 	Size windowSize;
 	GameState currentState;
 	int level;
-	int waitTimer;
+	TimerWheel<MAX_GAME_TIMERS> timers; // everything that happens after a countdown, see GameEvent
+	Random random; // every random decision in the game comes from here
+	GameStats stats;
 };
\ No newline at end of file
@@ -0,0 +1,1003 @@
+#include <iostream>
+#include "GameWorld.h"
+#include "GameDraw.h"
+#include "Renderer.h"
+#include "CursesUtils.h"
+#include "Snapshot.h"
+#include "AnsiBuffer.h"
+#include "Autopilot.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <new>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// textinvaders-bench: times the hot paths of a frame (update, collision, draw) one at a time
+// and prints one result per line, so two runs can be diffed to catch regressions
+
+using namespace std::chrono;
+
+#ifdef _WIN32
+const char* const NULL_DEVICE = "NUL";
+#else
+const char* const NULL_DEVICE = "/dev/null";
+#endif
+
+enum ReportFormat
+{
+	FORMAT_JSON = 0,
+	FORMAT_CSV
+};
+
+struct BenchOptions
+{
+	double minSeconds; // each benchmark runs at least this long
+	const char* filter; // only run benchmarks with this in their name
+	Size boardSize;
+	uint64_t seed;
+	ReportFormat format;
+	bool verify; // check the fast paths give the same results as the simple versions, instead of timing them
+};
+
+// runs the operation being measured the given number of times,
+// returns the bytes it sent to the terminal (0 for anything that doesn't draw)
+typedef std::function<long long(long long iterations)> BenchmarkBody;
+
+struct BenchmarkResult
+{
+	std::string name;
+	long long iterations;
+	double nanosecondsPerOp;
+	double allocationsPerOp;
+	double allocatedBytesPerOp;
+	double bytesWrittenPerOp;
+};
+
+bool ParseOptions(int argc, char* argv[], BenchOptions& options);
+void PrintUsage();
+
+void RunBenchmark(const BenchOptions& options, const char* name, const BenchmarkBody& body, std::vector<BenchmarkResult>& results);
+void WriteResult(const BenchOptions& options, const BenchmarkResult& result);
+
+int VerifyMissileCollisions(const BenchOptions& options);
+template<class LAYOUT> int CompareMissileCollisions(const BasicAlienSwarm<LAYOUT>& aliens, const Player& player, int width, int height, const char* state);
+
+// just enough of a terminal to play ComposeAnsiFrame's output back: characters, carriage return, and ESC [ H, C and 2J
+struct TestTerminal
+{
+	int width;
+	int height;
+	std::vector<char> cells;
+	int cursorX; // can be width after writing the last column, writing there is an error
+	int cursorY;
+};
+
+int VerifyAnsiFrames(const BenchOptions& options);
+int CompareAnsiFrame(AnsiBuffer& buffer, TestTerminal& terminal, const char* frame, const char* state);
+bool PlayAnsiOutput(TestTerminal& terminal, const char* bytes, int length);
+
+template<class LAYOUT> void ThinSwarm(BasicAlienSwarm<LAYOUT>& aliens, int percentAlive, Random& random);
+void MoveSwarmOntoShields(AlienSwarm& aliens, const Shield shields[]);
+
+// a swarm much bigger than the game's, to see how the swarm code scales with the layout
+typedef SwarmLayout<32, 48, ALIEN_SPRITE_WIDTH, ALIEN_SPRITE_HEIGHT, ALIENS_X_PADDING, ALIENS_Y_PADDING> LargeSwarmLayout;
+typedef BasicAlienSwarm<LargeSwarmLayout> LargeAlienSwarm;
+
+// far more bombs than any game fires, to check a frame's projectile work grows only with how many are live
+const int MAX_BENCH_PROJECTILES = 1 << 16;
+ProjectilePool<MAX_BENCH_PROJECTILES> benchProjectiles; // too big for the stack
+long long FileSize(FILE* file);
+
+// every allocation made through new is counted, so a benchmark that starts allocating in the hot loop shows up
+std::atomic<long long> numberOfAllocations(0);
+std::atomic<long long> numberOfAllocatedBytes(0);
+
+void* operator new(size_t size)
+{
+	numberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+	numberOfAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+volatile long long benchmarkSink; // results are added here so the optimizer can't drop the work
+
+int main(int argc, char* argv[])
+{
+	BenchOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (options.verify)
+	{
+		int mismatches = VerifyMissileCollisions(options) + VerifyAnsiFrames(options);
+
+		printf("%d mismatches\n", mismatches);
+		return mismatches == 0 ? 0 : 1;
+	}
+
+	std::vector<BenchmarkResult> results;
+
+	GameWorld startWorld;
+	InitGameWorld(startWorld, options.boardSize, options.seed);
+
+	Random random;
+	SeedRandom(random, options.seed, 1);
+
+	// UpdateGame with the swarm at a few densities, the player sweeping and firing.
+	// The world is put back every few hundred ticks so the swarm doesn't reach the bottom or get wiped out.
+	const int densities[] = { 100, 50, 10 };
+	for (int percentAlive : densities)
+	{
+		GameWorld thinnedWorld = startWorld;
+		ThinSwarm(thinnedWorld.aliens, percentAlive, random);
+
+		std::string name = "update_game/alive_" + std::to_string(percentAlive);
+
+		RunBenchmark(options, name.c_str(), [&thinnedWorld](long long iterations)
+		{
+			const int TICKS_BEFORE_RESET = 300;
+			GameWorld world = thinnedWorld;
+
+			for (long long i = 0; i < iterations; i++)
+			{
+				if (i % TICKS_BEFORE_RESET == 0)
+				{
+					world = thinnedWorld;
+				}
+
+				int input = ((i / 60) % 2 == 0 ? GI_RIGHT : GI_LEFT) | GI_FIRE;
+				HandleGameInput(world.game, world.player, input);
+				UpdateGame(world.game, world.player, world.shields, NUM_SHIELDS, world.aliens);
+			}
+
+			benchmarkSink += world.player.score;
+			return 0LL;
+		}, results);
+	}
+
+	// one frame of the bomb update with this many live: move them all, take out the ones that fell off the bottom
+	// and drop as many new ones in at the top, so the count stays put
+	const int projectileCounts[] = { 100, 1000, 10000, 60000 };
+	for (int numberOfProjectiles : projectileCounts)
+	{
+		ProjectilePool<MAX_BENCH_PROJECTILES>& pool = benchProjectiles;
+		InitProjectiles(pool);
+
+		for (int i = 0; i < numberOfProjectiles; i++)
+		{
+			SpawnProjectile(pool, RandomInt(random, options.boardSize.width), RandomInt(random, options.boardSize.height));
+		}
+
+		std::string name = "projectile_pool/move_and_remove_" + std::to_string(numberOfProjectiles);
+
+		RunBenchmark(options, name.c_str(), [&pool, numberOfProjectiles, &options](long long iterations)
+		{
+			const int height = options.boardSize.height;
+			long long removed = 0;
+
+			for (long long i = 0; i < iterations; i++)
+			{
+				MoveProjectiles(pool, 1, 2);
+
+				for (int p = pool.count - 1; p >= 0; p--)
+				{
+					if (pool.y[p] >= height)
+					{
+						RemoveProjectile(pool, p);
+						removed++;
+					}
+				}
+
+				for (int x = int(i % 37); pool.count < numberOfProjectiles; x += 37)
+				{
+					SpawnProjectile(pool, x % options.boardSize.width, 0);
+				}
+			}
+
+			benchmarkSink += removed;
+			return 0LL;
+		}, results);
+	}
+
+	// points spread over the whole board, so the collision tests see the usual mix of hits and misses
+	const int NUM_TEST_POINTS = 1024;
+	std::vector<Position> testPoints(NUM_TEST_POINTS);
+	for (Position& point : testPoints)
+	{
+		point.x = RandomInt(random, options.boardSize.width);
+		point.y = RandomInt(random, options.boardSize.height);
+	}
+
+	GameWorld halfWorld = startWorld;
+	ThinSwarm(halfWorld.aliens, 50, random);
+
+	RunBenchmark(options, "is_collision/projectile_shields", [&](long long iterations)
+	{
+		long long hits = 0;
+		Position collidePoint;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			hits += IsCollision(testPoints[i % NUM_TEST_POINTS], halfWorld.shields, NUM_SHIELDS, collidePoint);
+		}
+
+		benchmarkSink += hits;
+		return 0LL;
+	}, results);
+
+	RunBenchmark(options, "is_collision/missile_swarm", [&](long long iterations)
+	{
+		long long hits = 0;
+		Player player = halfWorld.player;
+		Position collidePosition;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			player.missile = testPoints[i % NUM_TEST_POINTS];
+			hits += IsCollision(player, halfWorld.aliens, collidePosition);
+		}
+
+		benchmarkSink += hits;
+		return 0LL;
+	}, results);
+
+	RunBenchmark(options, "is_collision/missile_swarm_brute_force", [&](long long iterations)
+	{
+		long long hits = 0;
+		Player player = halfWorld.player;
+		Position collidePosition;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			player.missile = testPoints[i % NUM_TEST_POINTS];
+			hits += IsCollisionBruteForce(player, halfWorld.aliens, collidePosition);
+		}
+
+		benchmarkSink += hits;
+		return 0LL;
+	}, results);
+
+	// the same two tests on the large swarm, with points spread over it instead of the board
+	LargeAlienSwarm largeSwarm;
+	InitSwarm(largeSwarm);
+	largeSwarm.position.x = 0;
+	largeSwarm.position.y = 0;
+	ThinSwarm(largeSwarm, 50, random);
+
+	std::vector<Position> largeSwarmPoints(NUM_TEST_POINTS);
+	for (Position& point : largeSwarmPoints)
+	{
+		point.x = RandomInt(random, LargeSwarmLayout::SWARM_WIDTH);
+		point.y = RandomInt(random, LargeSwarmLayout::SWARM_HEIGHT);
+	}
+
+	RunBenchmark(options, "is_collision/missile_swarm_32x48", [&](long long iterations)
+	{
+		long long hits = 0;
+		Player player = halfWorld.player;
+		Position collidePosition;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			player.missile = largeSwarmPoints[i % NUM_TEST_POINTS];
+			hits += IsCollision(player, largeSwarm, collidePosition);
+		}
+
+		benchmarkSink += hits;
+		return 0LL;
+	}, results);
+
+	RunBenchmark(options, "is_collision/missile_swarm_32x48_brute_force", [&](long long iterations)
+	{
+		long long hits = 0;
+		Player player = halfWorld.player;
+		Position collidePosition;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			player.missile = largeSwarmPoints[i % NUM_TEST_POINTS];
+			hits += IsCollisionBruteForce(player, largeSwarm, collidePosition);
+		}
+
+		benchmarkSink += hits;
+		return 0LL;
+	}, results);
+
+	RunBenchmark(options, "is_collision/projectile_sprite", [&](long long iterations)
+	{
+		long long hits = 0;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			hits += IsCollision(testPoints[i % NUM_TEST_POINTS], halfWorld.player.position, halfWorld.player.spriteSize);
+		}
+
+		benchmarkSink += hits;
+		return 0LL;
+	}, results);
+
+	RunBenchmark(options, "find_empty_rows_and_columns", [&](long long iterations)
+	{
+		long long total = 0;
+		int emptyColsLeft, emptyColsRight, emptyRowsBottom;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			FindEmptyRowsAndColumns(halfWorld.aliens, emptyColsLeft, emptyColsRight, emptyRowsBottom);
+			total += emptyColsLeft + emptyColsRight + emptyRowsBottom;
+		}
+
+		benchmarkSink += total;
+		return 0LL;
+	}, results);
+
+	// the swarm pushed down so its bottom row sits on the shields, the shields are repaired before every call
+	GameWorld invadedWorld = startWorld;
+	MoveSwarmOntoShields(invadedWorld.aliens, invadedWorld.shields);
+
+	RunBenchmark(options, "destroy_shields", [&](long long iterations)
+	{
+		long long cellsDestroyed = 0;
+		Shield shields[NUM_SHIELDS];
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			memcpy(shields, invadedWorld.shields, sizeof(shields));
+			cellsDestroyed += DestroyShields(invadedWorld.aliens, shields, NUM_SHIELDS);
+		}
+
+		benchmarkSink += cellsDestroyed;
+		return 0LL;
+	}, results);
+
+	RunBenchmark(options, "collide_shields_with_alien", [&](long long iterations)
+	{
+		long long cellsDestroyed = 0;
+		Shield shields[NUM_SHIELDS];
+		const Position& shieldPosition = invadedWorld.shields[0].position;
+		const Size alienSize = { ALIEN_SPRITE_WIDTH, ALIEN_SPRITE_HEIGHT };
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			memcpy(shields, invadedWorld.shields, sizeof(shields));
+			cellsDestroyed += CollideShieldsWithAlien(shields, NUM_SHIELDS, shieldPosition.x + int(i % SHIELD_SPRITE_WIDTH), shieldPosition.y,
+				FrameMask(ALIEN10_SPRITE, 0), alienSize);
+		}
+
+		benchmarkSink += cellsDestroyed;
+		return 0LL;
+	}, results);
+
+	// DrawGame on consecutive frames of a real game, into curses on a temporary file instead of the terminal
+	const int NUM_RECORDED_FRAMES = 600;
+	std::vector<GameWorld> frames(NUM_RECORDED_FRAMES);
+	GameWorld world = startWorld;
+	for (int i = 0; i < NUM_RECORDED_FRAMES; i++)
+	{
+		StepGameWorld(world, ((i / 60) % 2 == 0 ? GI_RIGHT : GI_LEFT) | GI_FIRE);
+		frames[i] = world;
+	}
+
+	// what rollback and search lean on: taking, restoring and comparing whole worlds
+	SnapshotStack snapshots;
+	InitSnapshotStack(snapshots, NUM_RECORDED_FRAMES);
+
+	RunBenchmark(options, "snapshot/push_pop", [&](long long iterations)
+	{
+		GameWorld restored;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			if (snapshots.count == NUM_RECORDED_FRAMES)
+			{
+				PopSnapshot(snapshots, restored);
+			}
+
+			PushSnapshot(snapshots, frames[i % NUM_RECORDED_FRAMES]);
+		}
+
+		benchmarkSink += snapshots.count;
+		return 0LL;
+	}, results);
+
+	RunBenchmark(options, "snapshot/hash", [&](long long iterations)
+	{
+		uint64_t hashes = 0;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			hashes += HashGameWorld(frames[i % NUM_RECORDED_FRAMES]);
+		}
+
+		benchmarkSink += (long long)hashes;
+		return 0LL;
+	}, results);
+
+	// one decision with the game's settings, on this thread and then spread over every core
+	Autopilot autopilot;
+	InitAutopilot(autopilot, options.seed);
+
+	RunBenchmark(options, "autopilot/choose_input", [&](long long iterations)
+	{
+		long long inputs = 0;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			inputs += ChooseAutopilotInput(autopilot, frames[i % NUM_RECORDED_FRAMES], NULL);
+		}
+
+		benchmarkSink += inputs;
+		return 0LL;
+	}, results);
+
+	ThreadPool pool;
+	StartThreadPool(pool);
+
+	RunBenchmark(options, "autopilot/choose_input_pool", [&](long long iterations)
+	{
+		long long inputs = 0;
+
+		for (long long i = 0; i < iterations; i++)
+		{
+			inputs += ChooseAutopilotInput(autopilot, frames[i % NUM_RECORDED_FRAMES], &pool);
+		}
+
+		benchmarkSink += inputs;
+		return 0LL;
+	}, results);
+
+	StopThreadPool(pool);
+
+	Renderer renderer;
+	InitRenderer(renderer, options.boardSize.width, options.boardSize.height);
+
+	RunBenchmark(options, "draw_game/render", [&](long long iterations)
+	{
+		for (long long i = 0; i < iterations; i++)
+		{
+			GameWorld& frame = frames[i % NUM_RECORDED_FRAMES];
+
+			BeginFrame(renderer);
+			DrawGame(renderer, frame.game, frame.player, frame.shields, NUM_SHIELDS, frame.aliens);
+		}
+
+		benchmarkSink += renderer.backBuffer[0];
+		return 0LL;
+	}, results);
+
+	// the same frames presented through each output backend, each starting from a blank screen
+	struct PresentBenchmark
+	{
+		const char* name;
+		OutputBackend backend;
+	};
+
+	const PresentBenchmark presentBenchmarks[] = {
+		{ "draw_game/present_curses", OB_CURSES },
+		{ "draw_game/present_ansi", OB_ANSI }
+	};
+
+	for (const PresentBenchmark& presentBenchmark : presentBenchmarks)
+	{
+		FILE* output = tmpfile();
+		FILE* input = fopen(NULL_DEVICE, "r");
+
+		if (output == NULL || input == NULL ||
+			!InitializeOffscreenCurses(output, input, options.boardSize.width, options.boardSize.height, presentBenchmark.backend))
+		{
+			fprintf(stderr, "could not start curses offscreen, skipping %s\n", presentBenchmark.name);
+		}
+		else
+		{
+			InitRenderer(renderer, options.boardSize.width, options.boardSize.height);
+
+			RunBenchmark(options, presentBenchmark.name, [&](long long iterations)
+			{
+				long long startSize = FileSize(output);
+
+				for (long long i = 0; i < iterations; i++)
+				{
+					GameWorld& frame = frames[i % NUM_RECORDED_FRAMES];
+
+					BeginFrame(renderer);
+					DrawGame(renderer, frame.game, frame.player, frame.shields, NUM_SHIELDS, frame.aliens);
+					PresentFrame(renderer);
+				}
+
+				return FileSize(output) - startSize;
+			}, results);
+
+			ShutdownCurses();
+		}
+
+		if (input != NULL)
+		{
+			fclose(input);
+		}
+
+		if (output != NULL)
+		{
+			fclose(output);
+		}
+	}
+
+	if (options.format == FORMAT_CSV)
+	{
+		printf("name,iterations,ns_per_op,allocations_per_op,allocated_bytes_per_op,bytes_written_per_op\n");
+	}
+
+	for (const BenchmarkResult& result : results)
+	{
+		WriteResult(options, result);
+	}
+
+	return 0;
+}
+
+void RunBenchmark(const BenchOptions& options, const char* name, const BenchmarkBody& body, std::vector<BenchmarkResult>& results)
+{
+	if (options.filter != NULL && strstr(name, options.filter) == NULL)
+	{
+		return;
+	}
+
+	body(1); // warm the caches and anything lazily set up
+
+	// keep growing the batch until one takes long enough to time reliably
+	long long iterations = 1;
+
+	while (true)
+	{
+		long long allocationsBefore = numberOfAllocations.load();
+		long long allocatedBytesBefore = numberOfAllocatedBytes.load();
+
+		steady_clock::time_point startTime = steady_clock::now();
+		long long bytesWritten = body(iterations);
+		double seconds = duration<double>(steady_clock::now() - startTime).count();
+
+		if (seconds >= options.minSeconds || iterations >= (1LL << 40))
+		{
+			BenchmarkResult result;
+			result.name = name;
+			result.iterations = iterations;
+			result.nanosecondsPerOp = seconds * 1e9 / iterations;
+			result.allocationsPerOp = double(numberOfAllocations.load() - allocationsBefore) / iterations;
+			result.allocatedBytesPerOp = double(numberOfAllocatedBytes.load() - allocatedBytesBefore) / iterations;
+			result.bytesWrittenPerOp = double(bytesWritten) / iterations;
+			results.push_back(result);
+
+			fprintf(stderr, "%-40s %12.1f ns/op\n", name, result.nanosecondsPerOp);
+			return;
+		}
+
+		// aim a little past the target so we usually only need one more try
+		double scale = seconds > 0 ? options.minSeconds * 1.2 / seconds : 100;
+		iterations = (long long)(iterations * std::min(100.0, std::max(2.0, scale)));
+	}
+}
+
+void WriteResult(const BenchOptions& options, const BenchmarkResult& result)
+{
+	if (options.format == FORMAT_CSV)
+	{
+		printf("%s,%lld,%.2f,%.4f,%.2f,%.2f\n", result.name.c_str(), result.iterations, result.nanosecondsPerOp,
+			result.allocationsPerOp, result.allocatedBytesPerOp, result.bytesWrittenPerOp);
+	}
+	else
+	{
+		// one object per line, easy to diff and to load into anything
+		printf("{\"name\": \"%s\", \"iterations\": %lld, \"ns_per_op\": %.2f, \"allocations_per_op\": %.4f, "
+			"\"allocated_bytes_per_op\": %.2f, \"bytes_written_per_op\": %.2f}\n",
+			result.name.c_str(), result.iterations, result.nanosecondsPerOp,
+			result.allocationsPerOp, result.allocatedBytesPerOp, result.bytesWrittenPerOp);
+	}
+}
+
+// IsCollision against IsCollisionBruteForce for a missile on every cell of the board, with the swarm thinned out to
+// a few densities, some of it exploding, both animation frames and a couple of positions, and the same for the large swarm
+int VerifyMissileCollisions(const BenchOptions& options)
+{
+	GameWorld startWorld;
+	InitGameWorld(startWorld, options.boardSize, options.seed);
+
+	Random random;
+	SeedRandom(random, options.seed, 2);
+
+	const int densities[] = { 100, 75, 50, 10, 1, 0 };
+	const int swarmMoves[] = { 0, 7 }; // columns and rows the swarm is moved right and down
+	int mismatches = 0;
+
+	for (int percentAlive : densities)
+	{
+		AlienSwarm aliens = startWorld.aliens;
+		ThinSwarm(aliens, percentAlive, random);
+
+		LargeAlienSwarm largeSwarm;
+		InitSwarm(largeSwarm);
+		ThinSwarm(largeSwarm, percentAlive, random);
+
+		// a few explosions, an exploding alien can't be hit again
+		for (int explosions = 0, tries = 0; explosions < 3 && tries < 1000; tries++)
+		{
+			Position alien = { RandomInt(random, AlienSwarm::Layout::NUM_COLS), RandomInt(random, AlienSwarm::Layout::NUM_ROWS) };
+
+			if (GetAlienState(aliens, alien.y, alien.x) == AS_ALIVE)
+			{
+				ResolveAlienCollision(aliens, alien);
+				explosions++;
+			}
+		}
+
+		for (int move : swarmMoves)
+		{
+			for (int animation = 0; animation < 2; animation++)
+			{
+				char state[64];
+				snprintf(state, sizeof(state), "%d%% alive, moved %d, animation %d", percentAlive, move, animation);
+
+				AlienSwarm movedAliens = aliens;
+				movedAliens.position.x += move;
+				movedAliens.position.y += move;
+				movedAliens.animation = animation;
+
+				mismatches += CompareMissileCollisions(movedAliens, startWorld.player, options.boardSize.width, options.boardSize.height, state);
+
+				LargeAlienSwarm movedLargeSwarm = largeSwarm;
+				movedLargeSwarm.position.x = move;
+				movedLargeSwarm.position.y = move;
+				movedLargeSwarm.animation = animation;
+
+				mismatches += CompareMissileCollisions(movedLargeSwarm, startWorld.player,
+					LargeSwarmLayout::SWARM_WIDTH + 2 * move, LargeSwarmLayout::SWARM_HEIGHT + 2 * move, state);
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+// sweeps the missile one cell past every edge of a width by height board, both tests have to agree on the hit and the alien
+template<class LAYOUT>
+int CompareMissileCollisions(const BasicAlienSwarm<LAYOUT>& aliens, const Player& player, int width, int height, const char* state)
+{
+	const int MAX_MISMATCHES_SHOWN = 10;
+	Player testPlayer = player;
+	int mismatches = 0;
+
+	for (int y = -1; y <= height; y++)
+	{
+		for (int x = -1; x <= width; x++)
+		{
+			testPlayer.missile.x = x;
+			testPlayer.missile.y = y;
+
+			Position hit, bruteForceHit;
+			bool isHit = IsCollision(testPlayer, aliens, hit);
+			bool isBruteForceHit = IsCollisionBruteForce(testPlayer, aliens, bruteForceHit);
+
+			if (isHit != isBruteForceHit || hit.x != bruteForceHit.x || hit.y != bruteForceHit.y)
+			{
+				if (mismatches < MAX_MISMATCHES_SHOWN)
+				{
+					fprintf(stderr, "%dx%d swarm, %s: missile at (%d, %d) hits %d (col %d, row %d), brute force %d (col %d, row %d)\n",
+						LAYOUT::NUM_COLS, LAYOUT::NUM_ROWS, state, x, y, isHit, hit.x, hit.y, isBruteForceHit, bruteForceHit.x, bruteForceHit.y);
+				}
+
+				mismatches++;
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+// ComposeAnsiFrame's output played into a TestTerminal has to leave exactly the frame it was given on the screen,
+// for consecutive frames of a real game, the same with the occasional full redraw, and random changes sparse and dense
+int VerifyAnsiFrames(const BenchOptions& options)
+{
+	const int width = options.boardSize.width;
+	const int height = options.boardSize.height;
+	const int NUM_GAME_FRAMES = 600;
+	const int FRAMES_BETWEEN_REDRAWS = 97;
+
+	GameWorld world;
+	InitGameWorld(world, options.boardSize, options.seed);
+
+	Renderer renderer;
+	InitRenderer(renderer, width, height, false);
+
+	AnsiBuffer buffer;
+	InitAnsiBuffer(buffer, width, height, false);
+	AnsiRedrawAll(buffer); // the terminal starts out in an unknown state, like after StartAnsiOutput
+
+	TestTerminal terminal;
+	terminal.width = width;
+	terminal.height = height;
+	terminal.cells.assign(width * height, '?');
+	terminal.cursorX = 0;
+	terminal.cursorY = 0;
+
+	int mismatches = 0;
+	char state[64];
+
+	for (int i = 0; i < NUM_GAME_FRAMES; i++)
+	{
+		StepGameWorld(world, ((i / 60) % 2 == 0 ? GI_RIGHT : GI_LEFT) | GI_FIRE);
+
+		BeginFrame(renderer);
+		DrawGame(renderer, world.game, world.player, world.shields, NUM_SHIELDS, world.aliens);
+
+		if (i % FRAMES_BETWEEN_REDRAWS == FRAMES_BETWEEN_REDRAWS - 1)
+		{
+			AnsiRedrawAll(buffer);
+		}
+
+		snprintf(state, sizeof(state), "game frame %d", i);
+		mismatches += CompareAnsiFrame(buffer, terminal, renderer.backBuffer.data(), state);
+	}
+
+	// a few cells, then about half of them, changed at random each frame, so the runs and gaps come in every length
+	Random random;
+	SeedRandom(random, options.seed, 3);
+
+	const int percentsChanged[] = { 1, 5, 50 };
+	std::vector<char> frame = renderer.backBuffer;
+
+	for (int percentChanged : percentsChanged)
+	{
+		for (int i = 0; i < 200; i++)
+		{
+			for (char& cell : frame)
+			{
+				if (RandomInt(random, 100) < percentChanged)
+				{
+					cell = RandomInt(random, 4) == 0 ? ' ' : char('a' + RandomInt(random, 26));
+				}
+			}
+
+			snprintf(state, sizeof(state), "%d%% changed, frame %d", percentChanged, i);
+			mismatches += CompareAnsiFrame(buffer, terminal, frame.data(), state);
+		}
+	}
+
+	return mismatches;
+}
+
+// 1 if the terminal doesn't end up showing frame, or ComposeAnsiFrame sent something the TestTerminal can't play
+int CompareAnsiFrame(AnsiBuffer& buffer, TestTerminal& terminal, const char* frame, const char* state)
+{
+	int length = ComposeAnsiFrame(buffer, frame);
+
+	if (!PlayAnsiOutput(terminal, buffer.output.data(), length))
+	{
+		fprintf(stderr, "ansi output, %s: unexpected output\n", state);
+		return 1;
+	}
+
+	for (int i = 0; i < terminal.width * terminal.height; i++)
+	{
+		if (terminal.cells[i] != frame[i])
+		{
+			fprintf(stderr, "ansi output, %s: (%d, %d) shows '%c', should be '%c'\n", state,
+				i % terminal.width, i / terminal.width, terminal.cells[i], frame[i]);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+bool PlayAnsiOutput(TestTerminal& terminal, const char* bytes, int length)
+{
+	const char* end = bytes + length;
+
+	while (bytes < end)
+	{
+		char c = *bytes++;
+
+		if (c == '\r')
+		{
+			terminal.cursorX = 0;
+		}
+		else if (c == '\x1b')
+		{
+			if (bytes == end || *bytes++ != '[')
+			{
+				return false;
+			}
+
+			int numbers[2] = { 0, 0 };
+			int numberOfNumbers = 0;
+
+			while (bytes < end && ((*bytes >= '0' && *bytes <= '9') || *bytes == ';'))
+			{
+				if (*bytes == ';')
+				{
+					numberOfNumbers++;
+				}
+				else if (numberOfNumbers < 2)
+				{
+					numbers[numberOfNumbers] = numbers[numberOfNumbers] * 10 + (*bytes - '0');
+				}
+
+				bytes++;
+			}
+
+			if (bytes == end)
+			{
+				return false;
+			}
+
+			char command = *bytes++;
+
+			// a number that is left out counts as 1, except for J
+			if (command == 'H')
+			{
+				terminal.cursorY = std::max(numbers[0], 1) - 1;
+				terminal.cursorX = std::max(numbers[1], 1) - 1;
+			}
+			else if (command == 'C')
+			{
+				terminal.cursorX = std::min(terminal.cursorX + std::max(numbers[0], 1), terminal.width - 1);
+			}
+			else if (command == 'J' && numbers[0] == 2)
+			{
+				std::fill(terminal.cells.begin(), terminal.cells.end(), ' ');
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else
+		{
+			if (terminal.cursorX >= terminal.width || terminal.cursorY >= terminal.height)
+			{
+				return false; // terminals disagree on what happens here
+			}
+
+			terminal.cells[terminal.cursorY * terminal.width + terminal.cursorX++] = c;
+		}
+	}
+
+	return true;
+}
+
+// kills aliens at random until only percentAlive of them are left, and clears the explosions straight away
+template<class LAYOUT>
+void ThinSwarm(BasicAlienSwarm<LAYOUT>& aliens, int percentAlive, Random& random)
+{
+	int aliensToKeep = LAYOUT::NUM_ALIENS * percentAlive / 100;
+
+	while (aliens.numAliensLeft > aliensToKeep)
+	{
+		Position alien = { RandomInt(random, LAYOUT::NUM_COLS), RandomInt(random, LAYOUT::NUM_ROWS) };
+
+		if (GetAlienState(aliens, alien.y, alien.x) == AS_ALIVE)
+		{
+			ResolveAlienCollision(aliens, alien);
+		}
+	}
+
+	ExpireExplosions(aliens);
+}
+
+void MoveSwarmOntoShields(AlienSwarm& aliens, const Shield shields[])
+{
+	aliens.position.y = shields[0].position.y - AlienSwarm::Layout::rowOffset[AlienSwarm::Layout::NUM_ROWS - 1];
+}
+
+long long FileSize(FILE* file)
+{
+	fflush(file);
+	fseek(file, 0, SEEK_END);
+	return ftell(file);
+}
+
+bool ParseOptions(int argc, char* argv[], BenchOptions& options)
+{
+	options.minSeconds = 0.5;
+	options.filter = NULL;
+	options.boardSize.width = 120;
+	options.boardSize.height = 40;
+	options.seed = 1;
+	options.format = FORMAT_JSON;
+	options.verify = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (option == "--verify")
+		{
+			options.verify = true;
+			continue; // the only option without a value
+		}
+
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (option == "--min-time")
+		{
+			options.minSeconds = atof(value);
+		}
+		else if (option == "--filter")
+		{
+			options.filter = value;
+		}
+		else if (option == "--width")
+		{
+			options.boardSize.width = atoi(value);
+		}
+		else if (option == "--height")
+		{
+			options.boardSize.height = atoi(value);
+		}
+		else if (option == "--seed")
+		{
+			options.seed = strtoull(value, NULL, 10);
+		}
+		else if (option == "--format")
+		{
+			if (strcmp(value, "json") == 0)
+			{
+				options.format = FORMAT_JSON;
+			}
+			else if (strcmp(value, "csv") == 0)
+			{
+				options.format = FORMAT_CSV;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		i++;
+	}
+
+	return options.minSeconds > 0 && options.boardSize.width > 0 && options.boardSize.height > 0;
+}
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: textinvaders-bench [--min-time seconds] [--filter name] [--seed S]\n"
+		"                          [--width W] [--height H] [--format json|csv] [--verify]\n"
+		"--verify checks the fast collision tests against the brute force ones, and that the ANSI backend's\n"
+		"output leaves the frame it was given on a terminal, instead of timing anything. It exits with 1 on any difference\n");
+}
@@ -0,0 +1,886 @@
+#include <iostream>
+#include "GameWorld.h"
+#include "GameDraw.h"
+#include "Renderer.h"
+#include "AnsiBuffer.h"
+#include "FrameBroadcast.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+// textinvaders-server: hosts many independent games in one process. Every connection to the Unix socket
+// is a game, played with raw keys and drawn with ANSI escape codes, so any terminal can play with
+//
+//	socat -,raw,echo=0 UNIX-CONNECT:/tmp/textinvaders.sock
+//
+// One thread runs an epoll loop over the sockets and a tick timer. On every tick it hands the sessions
+// to the worker pool in batches, each worker steps, draws and sends its batch, and the loop waits for
+// them all before touching the sessions again. Linux only.
+//
+// A second socket is for watching: every connection to it is shown one of the games, n and p (or the arrows)
+// switch between them. A game's frames are encoded once for all of its spectators, see FrameBroadcast.h.
+
+using namespace std::chrono;
+
+struct ServerOptions
+{
+	const char* socketPath;
+	const char* spectateSocketPath;
+	Size boardSize; // every session gets the same size, there is no way to ask a raw socket how big its terminal is
+	int numberOfThreads;
+	int batchSize; // sessions per task
+	int maxSessions;
+	int maxSpectators;
+	uint64_t seed;
+};
+
+// what epoll hands back for each fd, so the loop knows what woke it
+enum ConnectionKind
+{
+	CK_LISTENER = 0,
+	CK_SPECTATE_LISTENER,
+	CK_TIMER,
+	CK_PLAYER,
+	CK_SPECTATOR
+};
+
+struct Connection
+{
+	ConnectionKind kind;
+	void* owner; // the Session or Spectator, NULL for the server's own fds
+};
+
+enum KeyState
+{
+	KS_NORMAL = 0,
+	KS_ESCAPE, // seen ESC
+	KS_CONTROL_SEQUENCE // seen ESC [ or ESC O
+};
+
+const int KEY_NONE = -1; // in the middle of an escape sequence
+const int KEY_LEFT_ARROW = 256;
+const int KEY_RIGHT_ARROW = 257;
+
+struct Session
+{
+	Connection connection;
+	int socket;
+	GameWorld world;
+	Renderer renderer; // only its back buffer is used, the AnsiBuffer keeps what the client is showing
+	AnsiBuffer terminal;
+	int unsentOffset; // part of terminal.output still to send from the last frame, when the socket was full
+	int unsentLength;
+	int pendingInput; // GameInput flags from the keys since the last tick
+	KeyState keyState;
+	bool closing; // drop the connection after this tick
+	FrameBroadcast* broadcast; // created when the first spectator turns up
+};
+
+struct Spectator
+{
+	Connection connection;
+	Viewer viewer;
+	Session* watching; // NULL while there are no games to watch
+	KeyState keyState;
+};
+
+struct Server
+{
+	ServerOptions options;
+	int listenSocket;
+	int spectateSocket;
+	int timer;
+	int epoll;
+	Connection listenConnection;
+	Connection spectateConnection;
+	Connection timerConnection;
+	std::vector<Session*> sessions;
+	std::vector<Spectator*> spectators;
+	uint64_t sessionsStarted;
+	ThreadPool pool;
+
+	// for the stats line
+	steady_clock::time_point statsStartTime;
+	int ticksSinceStats;
+	double tickSecondsSinceStats;
+	double slowestTickSeconds;
+	long long bytesSentSinceStats;
+};
+
+const int STATS_INTERVAL_SECONDS = 10;
+
+// the cursor is hidden while playing and comes back when we say goodbye
+const char SESSION_START[] = "\x1b[?25l";
+const char SESSION_END[] = "\x1b[?25h\x1b[H\x1b[2J";
+const char NO_GAMES[] = "\x1b[H\x1b[2Jno games running, waiting for a player\r\n";
+
+bool ParseOptions(int argc, char* argv[], ServerOptions& options);
+void PrintUsage();
+
+bool StartServer(Server& server, const ServerOptions& options);
+void StopServer(Server& server);
+void RunServer(Server& server);
+
+int Listen(const char* socketPath);
+bool RemoveSocketFile(const char* socketPath);
+void Watch(int epoll, int socket, Connection& connection);
+
+void AcceptSessions(Server& server);
+void AcceptSpectators(Server& server);
+int ReceiveKeys(int socket, unsigned char keys[], int maxKeys);
+int DecodeKey(KeyState& keyState, unsigned char key);
+void ReadInput(Session& session);
+void HandleKey(Session& session, int key);
+void ReadSpectatorInput(Server& server, Spectator& spectator);
+void WatchSession(Server& server, Spectator& spectator, Session* session);
+void Tick(Server& server, int numberOfTicks);
+long long UpdateSessions(Session* const sessions[], int numberOfSessions, int numberOfTicks);
+int SendOutput(Session& session);
+void CloseSessions(Server& server);
+void CloseSpectators(Server& server);
+void WriteStats(Server& server);
+
+volatile sig_atomic_t stopRequested = 0;
+
+void RequestStop(int)
+{
+	stopRequested = 1;
+}
+
+int main(int argc, char* argv[])
+{
+	ServerOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	signal(SIGINT, RequestStop);
+	signal(SIGTERM, RequestStop);
+
+	Server server;
+
+	if (!StartServer(server, options))
+	{
+		return 1;
+	}
+
+	fprintf(stderr, "listening on %s, spectators on %s, %dx%d boards, %d worker threads\n", options.socketPath,
+		options.spectateSocketPath, options.boardSize.width, options.boardSize.height, int(server.pool.workers.size()));
+
+	RunServer(server);
+	StopServer(server);
+
+	return 0;
+}
+
+bool StartServer(Server& server, const ServerOptions& options)
+{
+	server.options = options;
+	server.sessionsStarted = 0;
+	server.statsStartTime = steady_clock::now();
+	server.ticksSinceStats = 0;
+	server.tickSecondsSinceStats = 0;
+	server.slowestTickSeconds = 0;
+	server.bytesSentSinceStats = 0;
+
+	server.listenSocket = Listen(options.socketPath);
+	server.spectateSocket = server.listenSocket >= 0 ? Listen(options.spectateSocketPath) : -1;
+
+	if (server.spectateSocket < 0)
+	{
+		return false;
+	}
+
+	// the timer keeps the ticks on schedule however long each one takes, late ticks show up as extra expirations
+	server.timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	itimerspec interval;
+	interval.it_interval.tv_sec = 0;
+	interval.it_interval.tv_nsec = 1000000000L / FPS;
+	interval.it_value = interval.it_interval;
+	timerfd_settime(server.timer, 0, &interval, NULL);
+
+	server.epoll = epoll_create1(EPOLL_CLOEXEC);
+
+	server.listenConnection.kind = CK_LISTENER;
+	server.spectateConnection.kind = CK_SPECTATE_LISTENER;
+	server.timerConnection.kind = CK_TIMER;
+	server.listenConnection.owner = server.spectateConnection.owner = server.timerConnection.owner = NULL;
+
+	Watch(server.epoll, server.listenSocket, server.listenConnection);
+	Watch(server.epoll, server.spectateSocket, server.spectateConnection);
+	Watch(server.epoll, server.timer, server.timerConnection);
+
+	StartThreadPool(server.pool, options.numberOfThreads);
+
+	return true;
+}
+
+void StopServer(Server& server)
+{
+	StopThreadPool(server.pool);
+
+	for (Session* session : server.sessions)
+	{
+		send(session->socket, SESSION_END, sizeof(SESSION_END) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+		close(session->socket);
+	}
+
+	for (Spectator* spectator : server.spectators)
+	{
+		send(spectator->viewer.socket, SESSION_END, sizeof(SESSION_END) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+		close(spectator->viewer.socket);
+		delete spectator;
+	}
+
+	for (Session* session : server.sessions)
+	{
+		delete session->broadcast;
+		delete session;
+	}
+
+	server.sessions.clear();
+	server.spectators.clear();
+
+	close(server.epoll);
+	close(server.timer);
+	close(server.listenSocket);
+	close(server.spectateSocket);
+	RemoveSocketFile(server.options.socketPath);
+	RemoveSocketFile(server.options.spectateSocketPath);
+}
+
+int Listen(const char* socketPath)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (strlen(socketPath) >= sizeof(address.sun_path))
+	{
+		fprintf(stderr, "socket path %s is too long\n", socketPath);
+		return -1;
+	}
+
+	strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+	if (!RemoveSocketFile(socketPath)) // left over from a server that didn't shut down cleanly
+	{
+		fprintf(stderr, "%s is already there and isn't a socket, not replacing it\n", socketPath);
+		return -1;
+	}
+
+	int listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenSocket < 0 ||
+		bind(listenSocket, (sockaddr*)&address, sizeof(address)) < 0 ||
+		listen(listenSocket, SOMAXCONN) < 0)
+	{
+		fprintf(stderr, "could not listen on %s: %s\n", socketPath, strerror(errno));
+		return -1;
+	}
+
+	return listenSocket;
+}
+
+// removes the socket at socketPath if there is one, false if something other than a socket is there, which is left alone
+bool RemoveSocketFile(const char* socketPath)
+{
+	struct stat status;
+
+	if (lstat(socketPath, &status) < 0)
+	{
+		return errno == ENOENT;
+	}
+
+	return S_ISSOCK(status.st_mode) && unlink(socketPath) == 0;
+}
+
+void Watch(int epoll, int socket, Connection& connection)
+{
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = &connection;
+	epoll_ctl(epoll, EPOLL_CTL_ADD, socket, &event);
+}
+
+void RunServer(Server& server)
+{
+	const int MAX_EVENTS = 256;
+	epoll_event events[MAX_EVENTS];
+
+	while (!stopRequested)
+	{
+		int numberOfEvents = epoll_wait(server.epoll, events, MAX_EVENTS, -1);
+
+		for (int i = 0; i < numberOfEvents; i++)
+		{
+			Connection& connection = *(Connection*)events[i].data.ptr;
+
+			switch (connection.kind)
+			{
+			case CK_LISTENER:
+				AcceptSessions(server);
+				break;
+			case CK_SPECTATE_LISTENER:
+				AcceptSpectators(server);
+				break;
+			case CK_TIMER:
+			{
+				uint64_t expirations = 0;
+				if (read(server.timer, &expirations, sizeof(expirations)) == sizeof(expirations))
+				{
+					// if we fell behind, catch up a few ticks but drop anything more instead of fast forwarding
+					Tick(server, int(std::min<uint64_t>(expirations, MAX_TICKS_PER_FRAME)));
+				}
+				break;
+			}
+			case CK_PLAYER:
+				ReadInput(*(Session*)connection.owner);
+				break;
+			case CK_SPECTATOR:
+				ReadSpectatorInput(server, *(Spectator*)connection.owner);
+				break;
+			}
+		}
+
+		// spectators first, closing a session moves its spectators on to another game
+		CloseSpectators(server);
+		CloseSessions(server);
+	}
+}
+
+void AcceptSessions(Server& server)
+{
+	while (true)
+	{
+		int clientSocket = accept4(server.listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (clientSocket < 0)
+		{
+			return;
+		}
+
+		if (int(server.sessions.size()) >= server.options.maxSessions)
+		{
+			const char FULL[] = "server full\r\n";
+			send(clientSocket, FULL, sizeof(FULL) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+			close(clientSocket);
+			continue;
+		}
+
+		Session* session = new Session;
+		session->connection.kind = CK_PLAYER;
+		session->connection.owner = session;
+		session->socket = clientSocket;
+		session->unsentOffset = 0;
+		session->unsentLength = 0;
+		session->pendingInput = GI_NONE;
+		session->keyState = KS_NORMAL;
+		session->closing = false;
+		session->broadcast = NULL;
+
+		InitGameWorld(session->world, server.options.boardSize, server.options.seed + server.sessionsStarted++);
+
+		InitRenderer(session->renderer, server.options.boardSize.width, server.options.boardSize.height, false);
+		InitAnsiBuffer(session->terminal, server.options.boardSize.width, server.options.boardSize.height, false);
+		AnsiRedrawAll(session->terminal); // we have no idea what the client's terminal has on it
+
+		send(clientSocket, SESSION_START, sizeof(SESSION_START) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		Watch(server.epoll, clientSocket, session->connection);
+
+		server.sessions.push_back(session);
+
+		// anyone who was waiting for a game gets this one
+		for (Spectator* spectator : server.spectators)
+		{
+			if (spectator->watching == NULL)
+			{
+				WatchSession(server, *spectator, session);
+			}
+		}
+	}
+}
+
+void AcceptSpectators(Server& server)
+{
+	while (true)
+	{
+		int clientSocket = accept4(server.spectateSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (clientSocket < 0)
+		{
+			return;
+		}
+
+		if (int(server.spectators.size()) >= server.options.maxSpectators)
+		{
+			const char FULL[] = "too many spectators\r\n";
+			send(clientSocket, FULL, sizeof(FULL) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+			close(clientSocket);
+			continue;
+		}
+
+		Spectator* spectator = new Spectator;
+		spectator->connection.kind = CK_SPECTATOR;
+		spectator->connection.owner = spectator;
+		spectator->watching = NULL;
+		spectator->keyState = KS_NORMAL;
+		InitViewer(spectator->viewer, clientSocket);
+
+		send(clientSocket, SESSION_START, sizeof(SESSION_START) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		Watch(server.epoll, clientSocket, spectator->connection);
+
+		server.spectators.push_back(spectator);
+
+		WatchSession(server, *spectator, server.sessions.empty() ? NULL : server.sessions[0]);
+	}
+}
+
+// moves a spectator over to another game, which sends it a keyframe on the next tick, or to no game at all
+void WatchSession(Server& server, Spectator& spectator, Session* session)
+{
+	if (spectator.watching != NULL)
+	{
+		RemoveViewer(*spectator.watching->broadcast, &spectator.viewer);
+	}
+
+	spectator.watching = session;
+
+	if (session == NULL)
+	{
+		send(spectator.viewer.socket, NO_GAMES, sizeof(NO_GAMES) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+		return;
+	}
+
+	if (session->broadcast == NULL)
+	{
+		session->broadcast = new FrameBroadcast;
+		InitFrameBroadcast(*session->broadcast, server.options.boardSize.width, server.options.boardSize.height);
+	}
+
+	AddViewer(*session->broadcast, &spectator.viewer);
+}
+
+// returns the number of keys read, 0 if there are none right now, -1 if the client hung up
+int ReceiveKeys(int socket, unsigned char keys[], int maxKeys)
+{
+	while (true)
+	{
+		ssize_t numberOfKeys = recv(socket, keys, maxKeys, MSG_DONTWAIT);
+
+		if (numberOfKeys < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numberOfKeys == 0 || (numberOfKeys < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			return -1;
+		}
+
+		return numberOfKeys < 0 ? 0 : int(numberOfKeys);
+	}
+}
+
+// arrow keys arrive as ESC [ C / ESC [ D (or ESC O C / ESC O D in application mode), everything else is the byte itself
+int DecodeKey(KeyState& keyState, unsigned char key)
+{
+	switch (keyState)
+	{
+	case KS_ESCAPE:
+		keyState = (key == '[' || key == 'O') ? KS_CONTROL_SEQUENCE : KS_NORMAL;
+		return KEY_NONE;
+	case KS_CONTROL_SEQUENCE:
+		if (key >= 0x40 && key <= 0x7e)
+		{
+			keyState = KS_NORMAL; // the final byte of the sequence
+		}
+
+		return key == 'C' ? KEY_RIGHT_ARROW : key == 'D' ? KEY_LEFT_ARROW : KEY_NONE;
+	default:
+		break;
+	}
+
+	if (key == 0x1b)
+	{
+		keyState = KS_ESCAPE;
+		return KEY_NONE;
+	}
+
+	return key;
+}
+
+void ReadInput(Session& session)
+{
+	unsigned char keys[256];
+	int numberOfKeys;
+
+	while ((numberOfKeys = ReceiveKeys(session.socket, keys, sizeof(keys))) > 0)
+	{
+		for (int i = 0; i < numberOfKeys; i++)
+		{
+			HandleKey(session, DecodeKey(session.keyState, keys[i]));
+		}
+	}
+
+	if (numberOfKeys < 0)
+	{
+		session.closing = true; // the client hung up
+	}
+}
+
+// a and d work as well as the arrows
+void HandleKey(Session& session, int key)
+{
+	switch (key)
+	{
+	case ' ':
+		session.pendingInput |= GI_FIRE;
+		break;
+	case 'a':
+	case KEY_LEFT_ARROW:
+		session.pendingInput |= GI_LEFT;
+		break;
+	case 'd':
+	case KEY_RIGHT_ARROW:
+		session.pendingInput |= GI_RIGHT;
+		break;
+	case 'q':
+	case 3: // ctrl-c, the terminal is raw so it comes through as a key
+		session.closing = true;
+		break;
+	}
+}
+
+// n and p (or the arrows) switch to the next and previous game, q leaves
+void ReadSpectatorInput(Server& server, Spectator& spectator)
+{
+	unsigned char keys[256];
+	int numberOfKeys;
+
+	while ((numberOfKeys = ReceiveKeys(spectator.viewer.socket, keys, sizeof(keys))) > 0)
+	{
+		for (int i = 0; i < numberOfKeys; i++)
+		{
+			int key = DecodeKey(spectator.keyState, keys[i]);
+			int step = 0;
+
+			switch (key)
+			{
+			case 'n':
+			case KEY_RIGHT_ARROW:
+				step = 1;
+				break;
+			case 'p':
+			case KEY_LEFT_ARROW:
+				step = -1;
+				break;
+			case 'q':
+			case 3:
+				spectator.viewer.closing = true;
+				break;
+			}
+
+			int numberOfSessions = int(server.sessions.size());
+
+			if (step != 0 && numberOfSessions > 1)
+			{
+				// the sessions move around as others close, so a game's place in the list only lasts until the next tick
+				int current = int(std::find(server.sessions.begin(), server.sessions.end(), spectator.watching) - server.sessions.begin());
+				WatchSession(server, spectator, server.sessions[(current + step + numberOfSessions) % numberOfSessions]);
+			}
+		}
+	}
+
+	if (numberOfKeys < 0)
+	{
+		spectator.viewer.closing = true;
+	}
+}
+
+void Tick(Server& server, int numberOfTicks)
+{
+	steady_clock::time_point startTime = steady_clock::now();
+
+	std::atomic<long long> bytesSent(0);
+	int numberOfSessions = int(server.sessions.size());
+
+	for (int first = 0; first < numberOfSessions; first += server.options.batchSize)
+	{
+		Session* const* batch = &server.sessions[first];
+		int batchSize = std::min(server.options.batchSize, numberOfSessions - first);
+
+		SubmitTask(server.pool, [batch, batchSize, numberOfTicks, &bytesSent]
+		{
+			bytesSent += UpdateSessions(batch, batchSize, numberOfTicks);
+		});
+	}
+
+	WaitForTasks(server.pool);
+
+	double seconds = duration<double>(steady_clock::now() - startTime).count();
+	server.ticksSinceStats++;
+	server.tickSecondsSinceStats += seconds;
+	server.slowestTickSeconds = std::max(server.slowestTickSeconds, seconds);
+	server.bytesSentSinceStats += bytesSent;
+
+	if (steady_clock::now() - server.statsStartTime >= std::chrono::seconds(STATS_INTERVAL_SECONDS))
+	{
+		WriteStats(server);
+	}
+}
+
+// runs on a worker, steps every session in the batch, draws it and sends what changed to the player and any spectators
+long long UpdateSessions(Session* const sessions[], int numberOfSessions, int numberOfTicks)
+{
+	long long bytesSent = 0;
+
+	for (int i = 0; i < numberOfSessions; i++)
+	{
+		Session& session = *sessions[i];
+
+		if (session.closing)
+		{
+			continue;
+		}
+
+		for (int tick = 0; tick < numberOfTicks; tick++)
+		{
+			StepGameWorld(session.world, session.pendingInput);
+			session.pendingInput = GI_NONE;
+		}
+
+		bool watched = session.broadcast != NULL && !session.broadcast->viewers.empty();
+
+		if (session.unsentLength == 0 || watched)
+		{
+			BeginFrame(session.renderer);
+			DrawGame(session.renderer, session.world.game, session.world.player, session.world.shields, NUM_SHIELDS, session.world.aliens);
+		}
+
+		// a client that hasn't taken the last frame yet doesn't get a new one, the AnsiBuffer still knows what
+		// it was last sent, so the frame after it catches up includes everything that changed in the meantime
+		if (session.unsentLength == 0)
+		{
+			session.unsentOffset = 0;
+			session.unsentLength = ComposeAnsiFrame(session.terminal, session.renderer.backBuffer.data());
+		}
+
+		bytesSent += SendOutput(session);
+
+		if (watched)
+		{
+			bytesSent += BroadcastFrame(*session.broadcast, session.renderer.backBuffer.data());
+		}
+	}
+
+	return bytesSent;
+}
+
+int SendOutput(Session& session)
+{
+	int bytesSent = 0;
+
+	while (session.unsentLength > 0)
+	{
+		ssize_t sent = send(session.socket, session.terminal.output.data() + session.unsentOffset, session.unsentLength,
+			MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		if (sent < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				session.closing = true;
+			}
+
+			if (errno != EINTR)
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		session.unsentOffset += int(sent);
+		session.unsentLength -= int(sent);
+		bytesSent += int(sent);
+	}
+
+	return bytesSent;
+}
+
+void CloseSessions(Server& server)
+{
+	for (size_t i = 0; i < server.sessions.size();)
+	{
+		Session* session = server.sessions[i];
+
+		if (session->closing)
+		{
+			send(session->socket, SESSION_END, sizeof(SESSION_END) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+			epoll_ctl(server.epoll, EPOLL_CTL_DEL, session->socket, NULL);
+			close(session->socket);
+
+			server.sessions[i] = server.sessions.back();
+			server.sessions.pop_back();
+
+			// its spectators move on to the first game left, or wait for the next one
+			if (session->broadcast != NULL)
+			{
+				for (Spectator* spectator : server.spectators)
+				{
+					if (spectator->watching == session)
+					{
+						WatchSession(server, *spectator, server.sessions.empty() ? NULL : server.sessions[0]);
+					}
+				}
+			}
+
+			delete session->broadcast;
+			delete session;
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void CloseSpectators(Server& server)
+{
+	for (size_t i = 0; i < server.spectators.size();)
+	{
+		Spectator* spectator = server.spectators[i];
+
+		if (spectator->viewer.closing)
+		{
+			if (spectator->watching != NULL)
+			{
+				RemoveViewer(*spectator->watching->broadcast, &spectator->viewer);
+			}
+
+			send(spectator->viewer.socket, SESSION_END, sizeof(SESSION_END) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+			epoll_ctl(server.epoll, EPOLL_CTL_DEL, spectator->viewer.socket, NULL);
+			close(spectator->viewer.socket);
+			delete spectator;
+
+			server.spectators[i] = server.spectators.back();
+			server.spectators.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void WriteStats(Server& server)
+{
+	double seconds = duration<double>(steady_clock::now() - server.statsStartTime).count();
+
+	fprintf(stderr, "%d sessions, %d spectators, %d ticks, tick average %.2f ms max %.2f ms, %.0f KB/s sent\n",
+		int(server.sessions.size()), int(server.spectators.size()), server.ticksSinceStats,
+		server.ticksSinceStats > 0 ? server.tickSecondsSinceStats * 1000 / server.ticksSinceStats : 0.0,
+		server.slowestTickSeconds * 1000, server.bytesSentSinceStats / 1024.0 / seconds);
+
+	server.statsStartTime = steady_clock::now();
+	server.ticksSinceStats = 0;
+	server.tickSecondsSinceStats = 0;
+	server.slowestTickSeconds = 0;
+	server.bytesSentSinceStats = 0;
+}
+
+bool ParseOptions(int argc, char* argv[], ServerOptions& options)
+{
+	options.socketPath = "/tmp/textinvaders.sock";
+	options.spectateSocketPath = "/tmp/textinvaders-watch.sock";
+	options.boardSize.width = 80;
+	options.boardSize.height = 24;
+	options.numberOfThreads = 0;
+	options.batchSize = 64;
+	options.maxSessions = 10000;
+	options.maxSpectators = 10000;
+	options.seed = uint64_t(time(NULL));
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (option == "--socket")
+		{
+			options.socketPath = value;
+		}
+		else if (option == "--spectate-socket")
+		{
+			options.spectateSocketPath = value;
+		}
+		else if (option == "--width")
+		{
+			options.boardSize.width = atoi(value);
+		}
+		else if (option == "--height")
+		{
+			options.boardSize.height = atoi(value);
+		}
+		else if (option == "--threads")
+		{
+			options.numberOfThreads = atoi(value);
+		}
+		else if (option == "--batch")
+		{
+			options.batchSize = atoi(value);
+		}
+		else if (option == "--max-sessions")
+		{
+			options.maxSessions = atoi(value);
+		}
+		else if (option == "--max-spectators")
+		{
+			options.maxSpectators = atoi(value);
+		}
+		else if (option == "--seed")
+		{
+			options.seed = strtoull(value, NULL, 10);
+		}
+		else
+		{
+			return false;
+		}
+
+		i++;
+	}
+
+	return options.boardSize.width > 0 && options.boardSize.height > 0 && options.batchSize > 0 && options.maxSessions > 0 && options.maxSpectators > 0;
+}
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: textinvaders-server [--socket path] [--spectate-socket path] [--width W] [--height H] [--threads N]\n"
+		"                           [--batch sessions per task] [--max-sessions N] [--max-spectators N] [--seed S]\n");
+}
@@ -0,0 +1,310 @@
+#include <iostream>
+#include "GameWorld.h"
+#include "ThreadPool.h"
+#include "Autopilot.h"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// textinvaders-sim: runs a batch of seeded games headless across every core and reports what happened in each,
+// for balancing SwarmStepDelay, TicksUntilBombVolley and friends
+
+using namespace std::chrono;
+
+enum Policy
+{
+	POLICY_IDLE = 0,
+	POLICY_SWEEP,
+	POLICY_RANDOM,
+	POLICY_AUTOPILOT
+};
+
+enum ReportFormat
+{
+	FORMAT_CSV = 0,
+	FORMAT_JSON
+};
+
+struct SimOptions
+{
+	int numberOfGames;
+	int maxFrames;
+	uint64_t seed;
+	int numberOfThreads;
+	Policy policy;
+	int autopilotRollouts; // for each input the autopilot considers, fewer than in the game as every core is already busy with a game
+	int autopilotDepth;
+	Size boardSize;
+	ReportFormat format;
+};
+
+struct GameResult
+{
+	uint64_t seed;
+	int score;
+	int level;
+	int frames;
+	int bombsFired;
+	int shieldCellsDestroyed;
+	int playerHits;
+	int aliensLeft;
+};
+
+bool ParseOptions(int argc, char* argv[], SimOptions& options);
+void PrintUsage();
+
+void RunGame(const SimOptions& options, uint64_t seed, GameResult& result);
+int ChooseInput(Policy policy, const GameWorld& world, Random& random, int& direction, Autopilot& autopilot);
+bool IsGameFinished(const GameWorld& world);
+
+void WriteReport(const SimOptions& options, const std::vector<GameResult>& results);
+
+int main(int argc, char* argv[])
+{
+	SimOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<GameResult> results(options.numberOfGames);
+
+	ThreadPool pool;
+	StartThreadPool(pool, options.numberOfThreads);
+
+	steady_clock::time_point startTime = steady_clock::now();
+
+	for (int i = 0; i < options.numberOfGames; i++)
+	{
+		GameResult* result = &results[i];
+		uint64_t seed = options.seed + i;
+
+		SubmitTask(pool, [&options, seed, result] { RunGame(options, seed, *result); });
+	}
+
+	WaitForTasks(pool);
+
+	double seconds = duration<double>(steady_clock::now() - startTime).count();
+	int numberOfThreads = int(pool.workers.size());
+
+	StopThreadPool(pool);
+
+	WriteReport(options, results);
+
+	long long totalFrames = 0;
+	for (const GameResult& result : results)
+	{
+		totalFrames += result.frames;
+	}
+
+	fprintf(stderr, "%d games, %lld frames in %.3f s on %d threads: %.0f frames/s, %.0f frames/s per thread\n",
+		options.numberOfGames, totalFrames, seconds, numberOfThreads,
+		totalFrames / seconds, totalFrames / seconds / numberOfThreads);
+
+	return 0;
+}
+
+void RunGame(const SimOptions& options, uint64_t seed, GameResult& result)
+{
+	GameWorld world;
+	InitGameWorld(world, options.boardSize, seed);
+
+	Random policyRandom;
+	SeedRandom(policyRandom, seed, 1); // its own stream, so the policy doesn't disturb the game's randomness
+
+	int direction = 1;
+
+	Autopilot autopilot;
+	InitAutopilot(autopilot, seed, options.autopilotRollouts, options.autopilotDepth);
+
+	while (world.game.stats.frames < options.maxFrames && !IsGameFinished(world))
+	{
+		StepGameWorld(world, ChooseInput(options.policy, world, policyRandom, direction, autopilot));
+	}
+
+	result.seed = seed;
+	result.score = world.player.score;
+	result.level = world.game.level;
+	result.frames = world.game.stats.frames;
+	result.bombsFired = world.game.stats.bombsFired;
+	result.shieldCellsDestroyed = world.game.stats.shieldCellsDestroyed;
+	result.playerHits = world.game.stats.playerHits;
+	result.aliensLeft = world.aliens.numAliensLeft;
+}
+
+int ChooseInput(Policy policy, const GameWorld& world, Random& random, int& direction, Autopilot& autopilot)
+{
+	switch (policy)
+	{
+	case POLICY_SWEEP:
+		// walk from wall to wall firing whenever we can
+		if (world.player.position.x + world.player.spriteSize.width >= world.game.windowSize.width)
+		{
+			direction = -1;
+		}
+		else if (world.player.position.x <= 0)
+		{
+			direction = 1;
+		}
+
+		return (direction > 0 ? GI_RIGHT : GI_LEFT) | GI_FIRE;
+	case POLICY_RANDOM:
+		return int(NextRandom(random) & (GI_LEFT | GI_RIGHT | GI_FIRE));
+	case POLICY_AUTOPILOT:
+		return ChooseAutopilotInput(autopilot, world, NULL); // no deadline, so the same seed plays the same game
+	default:
+		return GI_NONE;
+	}
+}
+
+bool IsGameFinished(const GameWorld& world)
+{
+	return world.game.currentState == GS_GAME_OVER || world.aliens.occupiedColumns == 0;
+}
+
+void WriteReport(const SimOptions& options, const std::vector<GameResult>& results)
+{
+	if (options.format == FORMAT_CSV)
+	{
+		printf("seed,score,level,frames,bombs_fired,shield_cells_destroyed,player_hits,aliens_left\n");
+
+		for (const GameResult& result : results)
+		{
+			printf("%llu,%d,%d,%d,%d,%d,%d,%d\n", (unsigned long long)result.seed, result.score, result.level,
+				result.frames, result.bombsFired, result.shieldCellsDestroyed, result.playerHits, result.aliensLeft);
+		}
+	}
+	else
+	{
+		printf("[\n");
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const GameResult& result = results[i];
+
+			printf("  {\"seed\": %llu, \"score\": %d, \"level\": %d, \"frames\": %d, \"bombs_fired\": %d, "
+				"\"shield_cells_destroyed\": %d, \"player_hits\": %d, \"aliens_left\": %d}%s\n",
+				(unsigned long long)result.seed, result.score, result.level, result.frames, result.bombsFired,
+				result.shieldCellsDestroyed, result.playerHits, result.aliensLeft, i + 1 < results.size() ? "," : "");
+		}
+
+		printf("]\n");
+	}
+}
+
+bool ParseOptions(int argc, char* argv[], SimOptions& options)
+{
+	options.numberOfGames = 1000;
+	options.maxFrames = 10000;
+	options.seed = 1;
+	options.numberOfThreads = 0;
+	options.policy = POLICY_SWEEP;
+	options.autopilotRollouts = 16;
+	options.autopilotDepth = AUTOPILOT_DEPTH;
+	options.boardSize.width = 120;
+	options.boardSize.height = 40;
+	options.format = FORMAT_CSV;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (option == "--games")
+		{
+			options.numberOfGames = atoi(value);
+		}
+		else if (option == "--frames")
+		{
+			options.maxFrames = atoi(value);
+		}
+		else if (option == "--seed")
+		{
+			options.seed = strtoull(value, NULL, 10);
+		}
+		else if (option == "--threads")
+		{
+			options.numberOfThreads = atoi(value);
+		}
+		else if (option == "--rollouts")
+		{
+			options.autopilotRollouts = atoi(value);
+		}
+		else if (option == "--depth")
+		{
+			options.autopilotDepth = atoi(value);
+		}
+		else if (option == "--width")
+		{
+			options.boardSize.width = atoi(value);
+		}
+		else if (option == "--height")
+		{
+			options.boardSize.height = atoi(value);
+		}
+		else if (option == "--policy")
+		{
+			if (strcmp(value, "idle") == 0)
+			{
+				options.policy = POLICY_IDLE;
+			}
+			else if (strcmp(value, "sweep") == 0)
+			{
+				options.policy = POLICY_SWEEP;
+			}
+			else if (strcmp(value, "random") == 0)
+			{
+				options.policy = POLICY_RANDOM;
+			}
+			else if (strcmp(value, "autopilot") == 0)
+			{
+				options.policy = POLICY_AUTOPILOT;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if (option == "--format")
+		{
+			if (strcmp(value, "csv") == 0)
+			{
+				options.format = FORMAT_CSV;
+			}
+			else if (strcmp(value, "json") == 0)
+			{
+				options.format = FORMAT_JSON;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		i++;
+	}
+
+	return options.numberOfGames > 0 && options.maxFrames > 0 && options.autopilotRollouts > 0 && options.autopilotDepth > 0;
+}
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: textinvaders-sim [--games N] [--frames N] [--seed S] [--threads N]\n"
+		"                        [--policy idle|sweep|random|autopilot] [--rollouts N] [--depth N]\n"
+		"                        [--width W] [--height H] [--format csv|json]\n");
+}
@@ -0,0 +1,544 @@
+#include <iostream>
+#include "Stress.h"
+#include "GameDraw.h"
+#include "Renderer.h"
+#include "CursesUtils.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// textinvaders-stress: plays a board and swarm far bigger than any terminal (see Stress.h) and prints how long every phase
+// of every tick took, so we can see how each part of the engine scales before we ship the bigger variants.
+// --view shows a terminal sized window onto the board while it runs.
+
+using namespace std::chrono;
+
+enum ReportFormat
+{
+	FORMAT_CSV = 0,
+	FORMAT_JSON
+};
+
+struct StressOptions
+{
+	StressSettings settings;
+	int numberOfTicks;
+	int reportEvery; // only every Nth tick is printed, they are all in the summary
+	ReportFormat format;
+	const char* timingsFileName; // where the ticks are printed, stdout if there isn't one and we're not viewing
+	bool view;
+};
+
+// every tick's timings in nanoseconds, kept for the summary
+struct TickTimings
+{
+	std::vector<int64_t> phases[NUM_STRESS_PHASES];
+	std::vector<int64_t> ticks; // the whole of StepStressWorld
+};
+
+// the part of the board on the terminal
+struct Viewport
+{
+	Position position;
+	bool following; // keeps the first gunner in the middle of the bottom of the screen
+};
+
+const int VIEW_P99_TICKS = 128; // the status line's p99 is over this many of the most recent ticks
+
+bool ParseOptions(int argc, char* argv[], StressOptions& options);
+void PrintUsage();
+
+void RecordTick(TickTimings& timings, const StressWorld& world, int64_t tickNanoseconds);
+void WriteTickHeader(FILE* file, ReportFormat format);
+void WriteTick(FILE* file, ReportFormat format, const StressWorld& world, int64_t tickNanoseconds);
+void WriteSummary(FILE* file, const StressOptions& options, const StressWorld& world, const TickTimings& timings, double seconds);
+int64_t TimingPercentile(const std::vector<int64_t>& values, size_t first, int percent); // over values[first, end)
+
+bool HandleViewInput(Viewport& viewport, const Renderer& screen, int timeoutMilliseconds);
+void FollowGunner(Viewport& viewport, const Renderer& screen, const StressWorld& world);
+void DrawStressView(Renderer& screen, const Viewport& viewport, const StressWorld& world, const TickTimings& timings);
+
+int main(int argc, char* argv[])
+{
+	StressOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	StressWorld* world = new StressWorld; // the bomb pool and the explosion timers are big for the stack
+
+	if (!InitStressWorld(*world, options.settings))
+	{
+		fprintf(stderr, "a %dx%d swarm with %d shields and %d gunners doesn't fit on a %dx%d board\n",
+			options.settings.numberOfColumns, options.settings.numberOfRows, options.settings.numberOfShields,
+			options.settings.numberOfGunners, options.settings.fieldSize.width, options.settings.fieldSize.height);
+		delete world;
+		return 1;
+	}
+
+	FILE* timingsFile = options.view ? NULL : stdout;
+
+	if (options.timingsFileName != NULL)
+	{
+		timingsFile = fopen(options.timingsFileName, "w");
+
+		if (timingsFile == NULL)
+		{
+			fprintf(stderr, "could not write %s\n", options.timingsFileName);
+			delete world;
+			return 1;
+		}
+	}
+
+	if (timingsFile != NULL)
+	{
+		WriteTickHeader(timingsFile, options.format);
+	}
+
+	TickTimings timings;
+	Renderer screen;
+	Viewport viewport;
+
+	if (options.view)
+	{
+		InitializeCurses(false);
+		InitRenderer(screen, ScreenWidth(), ScreenHeight());
+		viewport.following = true;
+		FollowGunner(viewport, screen, *world);
+	}
+
+	steady_clock::time_point startTime = steady_clock::now();
+	steady_clock::time_point nextTickTime = startTime;
+	bool quit = false;
+
+	for (int tick = 0; tick < options.numberOfTicks && !quit && !IsStressSwarmEmpty(world->aliens); tick++)
+	{
+		steady_clock::time_point tickStartTime = steady_clock::now();
+		StepStressWorld(*world);
+		int64_t tickNanoseconds = duration_cast<nanoseconds>(steady_clock::now() - tickStartTime).count();
+
+		RecordTick(timings, *world, tickNanoseconds);
+
+		if (timingsFile != NULL && world->game.stats.frames % options.reportEvery == 0)
+		{
+			WriteTick(timingsFile, options.format, *world, tickNanoseconds);
+		}
+
+		if (options.view)
+		{
+			if (viewport.following)
+			{
+				FollowGunner(viewport, screen, *world);
+			}
+
+			DrawStressView(screen, viewport, *world, timings);
+			PresentFrame(screen);
+
+			// the board ticks at the game's rate while it's on screen, or as fast as it can if it can't keep up
+			nextTickTime = std::max(nextTickTime + duration_cast<steady_clock::duration>(seconds(1)) / FPS, steady_clock::now());
+
+			while (!quit && steady_clock::now() < nextTickTime)
+			{
+				int timeoutMilliseconds = int(duration_cast<milliseconds>(nextTickTime - steady_clock::now()).count());
+				quit = !HandleViewInput(viewport, screen, timeoutMilliseconds);
+			}
+		}
+	}
+
+	double elapsedSeconds = duration<double>(steady_clock::now() - startTime).count();
+
+	if (options.view)
+	{
+		ShutdownCurses();
+	}
+
+	if (timingsFile != NULL && timingsFile != stdout)
+	{
+		fclose(timingsFile);
+	}
+
+	WriteSummary(stderr, options, *world, timings, elapsedSeconds);
+
+	delete world;
+
+	return 0;
+}
+
+void RecordTick(TickTimings& timings, const StressWorld& world, int64_t tickNanoseconds)
+{
+	for (int phase = 0; phase < NUM_STRESS_PHASES; phase++)
+	{
+		timings.phases[phase].push_back(world.phaseNanoseconds[phase]);
+	}
+
+	timings.ticks.push_back(tickNanoseconds);
+}
+
+void WriteTickHeader(FILE* file, ReportFormat format)
+{
+	if (format != FORMAT_CSV)
+	{
+		return; // every JSON line names its fields
+	}
+
+	fprintf(file, "tick,aliens_left,bombs,tick_ns");
+
+	for (int phase = 0; phase < NUM_STRESS_PHASES; phase++)
+	{
+		fprintf(file, ",%s_ns", StressPhaseName(phase));
+	}
+
+	fprintf(file, "\n");
+}
+
+void WriteTick(FILE* file, ReportFormat format, const StressWorld& world, int64_t tickNanoseconds)
+{
+	if (format == FORMAT_CSV)
+	{
+		fprintf(file, "%d,%d,%d,%lld", world.game.stats.frames, world.aliens.numAliensLeft, world.aliens.bombs.count, (long long)tickNanoseconds);
+
+		for (int phase = 0; phase < NUM_STRESS_PHASES; phase++)
+		{
+			fprintf(file, ",%lld", (long long)world.phaseNanoseconds[phase]);
+		}
+
+		fprintf(file, "\n");
+	}
+	else
+	{
+		fprintf(file, "{\"tick\": %d, \"aliens_left\": %d, \"bombs\": %d, \"tick_ns\": %lld", world.game.stats.frames,
+			world.aliens.numAliensLeft, world.aliens.bombs.count, (long long)tickNanoseconds);
+
+		for (int phase = 0; phase < NUM_STRESS_PHASES; phase++)
+		{
+			fprintf(file, ", \"%s_ns\": %lld", StressPhaseName(phase), (long long)world.phaseNanoseconds[phase]);
+		}
+
+		fprintf(file, "}\n");
+	}
+}
+
+void WriteSummary(FILE* file, const StressOptions& options, const StressWorld& world, const TickTimings& timings, double seconds)
+{
+	const StressSettings& settings = options.settings;
+	int numberOfTicks = int(timings.ticks.size());
+
+	fprintf(file, "%d ticks in %.3f s on a %dx%d board: %dx%d swarm (%d aliens, %d left), %d shields, %d gunners, %s collisions\n",
+		numberOfTicks, seconds, settings.fieldSize.width, settings.fieldSize.height, settings.numberOfColumns, settings.numberOfRows,
+		settings.numberOfColumns * settings.numberOfRows, world.aliens.numAliensLeft, settings.numberOfShields, settings.numberOfGunners,
+		settings.bruteForce ? "brute force" : "grid");
+	fprintf(file, "%d bombs fired, %d gunner hits, %d shield cells destroyed\n",
+		world.game.stats.bombsFired, world.game.stats.playerHits, world.game.stats.shieldCellsDestroyed);
+
+	if (numberOfTicks == 0)
+	{
+		return;
+	}
+
+	fprintf(file, "%-20s %10s %10s %10s %10s\n", "us", "mean", "p50", "p99", "max");
+
+	for (int phase = 0; phase <= NUM_STRESS_PHASES; phase++)
+	{
+		const std::vector<int64_t>& values = phase < NUM_STRESS_PHASES ? timings.phases[phase] : timings.ticks;
+
+		long long total = 0;
+		for (int64_t value : values)
+		{
+			total += value;
+		}
+
+		fprintf(file, "%-20s %10.2f %10.2f %10.2f %10.2f\n", phase < NUM_STRESS_PHASES ? StressPhaseName(phase) : "tick",
+			total / 1000.0 / numberOfTicks, TimingPercentile(values, 0, 50) / 1000.0, TimingPercentile(values, 0, 99) / 1000.0,
+			*std::max_element(values.begin(), values.end()) / 1000.0);
+	}
+}
+
+int64_t TimingPercentile(const std::vector<int64_t>& values, size_t first, int percent)
+{
+	if (first >= values.size())
+	{
+		return 0;
+	}
+
+	std::vector<int64_t> sorted(values.begin() + first, values.end());
+
+	std::vector<int64_t>::iterator nth = sorted.begin() + (sorted.size() - 1) * percent / 100;
+	std::nth_element(sorted.begin(), nth, sorted.end());
+
+	return *nth;
+}
+
+// false if it's time to quit
+bool HandleViewInput(Viewport& viewport, const Renderer& screen, int timeoutMilliseconds)
+{
+	int input = GetCharTimeout(timeoutMilliseconds);
+
+	switch (input)
+	{
+	case AK_LEFT:
+		viewport.position.x -= screen.width / 4;
+		viewport.following = false;
+		break;
+	case AK_RIGHT:
+		viewport.position.x += screen.width / 4;
+		viewport.following = false;
+		break;
+	case AK_UP:
+		viewport.position.y -= screen.height / 4;
+		viewport.following = false;
+		break;
+	case AK_DOWN:
+		viewport.position.y += screen.height / 4;
+		viewport.following = false;
+		break;
+	case 'f':
+		viewport.following = true;
+		break;
+	case 'q':
+		return false;
+	}
+
+	return true;
+}
+
+void FollowGunner(Viewport& viewport, const Renderer& screen, const StressWorld& world)
+{
+	const Player& gunner = world.gunners[0];
+
+	viewport.position.x = gunner.position.x + gunner.spriteSize.width / 2 - screen.width / 2;
+	viewport.position.y = world.game.windowSize.height - screen.height;
+}
+
+void DrawStressView(Renderer& screen, const Viewport& viewport, const StressWorld& world, const TickTimings& timings)
+{
+	const StressSwarm& aliens = world.aliens;
+	const int viewX = viewport.position.x;
+	const int viewY = viewport.position.y;
+
+	BeginFrame(screen);
+
+	if (!IsStressSwarmEmpty(aliens))
+	{
+		// only the rows and columns on screen, with one either side, the renderer clips the rest
+		int firstRow = std::max((viewY - aliens.position.y) / ClassicSwarmLayout::CELL_HEIGHT - 1, 0);
+		int lastRow = std::min((viewY + screen.height - aliens.position.y) / ClassicSwarmLayout::CELL_HEIGHT, aliens.lastRow);
+		int firstColumn = std::max((viewX - aliens.position.x) / ClassicSwarmLayout::CELL_WIDTH - 1, aliens.firstColumn);
+		int lastColumn = std::min((viewX + screen.width - aliens.position.x) / ClassicSwarmLayout::CELL_WIDTH, aliens.lastColumn);
+
+		for (int row = firstRow; row <= lastRow; row++)
+		{
+			const AlienSprite& sprite = *ALIEN_SPRITES[aliens.rowType[row]];
+			int y = aliens.position.y + aliens.rowOffset[row] - viewY;
+
+			for (int col = firstColumn; col <= lastColumn; col++)
+			{
+				int x = aliens.position.x + aliens.columnOffset[col] - viewX;
+				int state = aliens.state[row * aliens.numberOfColumns + col];
+
+				if (state == AS_ALIVE)
+				{
+					RenderSprite(screen, x, y, sprite, aliens.animation);
+				}
+				else if (state == AS_EXPLODING)
+				{
+					RenderSprite(screen, x, y, ALIEN_EXPLOSION);
+				}
+			}
+		}
+	}
+
+	// shields and gunners are drawn by the game's own code, moved into screen coordinates
+	for (const Shield& shield : world.shields)
+	{
+		if (shield.position.x + SHIELD_SPRITE_WIDTH > viewX && shield.position.x < viewX + screen.width)
+		{
+			Shield onScreen = shield;
+			onScreen.position.x -= viewX;
+			onScreen.position.y -= viewY;
+			DrawShields(screen, &onScreen, 1);
+		}
+	}
+
+	for (const Player& gunner : world.gunners)
+	{
+		if (gunner.position.x + gunner.spriteSize.width > viewX && gunner.position.x < viewX + screen.width)
+		{
+			Player onScreen = gunner;
+			onScreen.position.x -= viewX;
+			onScreen.position.y -= viewY;
+
+			if (onScreen.missile.x != NOT_IN_PLAY)
+			{
+				onScreen.missile.x -= viewX;
+				onScreen.missile.y -= viewY;
+			}
+
+			DrawPlayer(screen, onScreen, false);
+		}
+	}
+
+	for (int i = 0; i < aliens.bombs.count; i++)
+	{
+		RenderCharacter(screen, aliens.bombs.x[i] - viewX, aliens.bombs.y[i] - viewY, ALIEN_BOMB_SPRITE.cells[aliens.bombs.animation[i]][0]);
+	}
+
+	size_t recent = timings.ticks.size() > VIEW_P99_TICKS ? timings.ticks.size() - VIEW_P99_TICKS : 0;
+
+	char line[160];
+	int length = snprintf(line, sizeof(line), " tick %d  aliens %d  bombs %d  tick p99 %.2fms  view %d,%d of %dx%d  arrows pan, f follows, q quits ",
+		world.game.stats.frames, aliens.numAliensLeft, aliens.bombs.count, TimingPercentile(timings.ticks, recent, 99) / 1000000.0,
+		viewX, viewY, world.game.windowSize.width, world.game.windowSize.height);
+
+	RenderString(screen, 0, 0, line, std::min(length, int(sizeof(line)) - 1));
+}
+
+bool ParseOptions(int argc, char* argv[], StressOptions& options)
+{
+	StressSettings& settings = options.settings;
+
+	settings.fieldSize.width = 4000;
+	settings.fieldSize.height = 1000;
+	settings.numberOfRows = 140;
+	settings.numberOfColumns = 700;
+	settings.numberOfShields = -1; // one for every 30 columns of board, like the game's four in 120
+	settings.numberOfGunners = 16;
+	settings.maxBombs = -1; // as many for each column as the game's swarm has
+	settings.startLines = 1;
+	settings.bruteForce = false;
+	settings.seed = 1;
+	options.numberOfTicks = 3000;
+	options.reportEvery = 1;
+	options.format = FORMAT_CSV;
+	options.timingsFileName = NULL;
+	options.view = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+
+		if (option == "--view")
+		{
+			options.view = true;
+			continue;
+		}
+
+		const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (option == "--width")
+		{
+			settings.fieldSize.width = atoi(value);
+		}
+		else if (option == "--height")
+		{
+			settings.fieldSize.height = atoi(value);
+		}
+		else if (option == "--rows")
+		{
+			settings.numberOfRows = atoi(value);
+		}
+		else if (option == "--cols")
+		{
+			settings.numberOfColumns = atoi(value);
+		}
+		else if (option == "--shields")
+		{
+			settings.numberOfShields = atoi(value);
+		}
+		else if (option == "--gunners")
+		{
+			settings.numberOfGunners = atoi(value);
+		}
+		else if (option == "--bombs")
+		{
+			settings.maxBombs = atoi(value);
+		}
+		else if (option == "--lines")
+		{
+			settings.startLines = atoi(value);
+		}
+		else if (option == "--seed")
+		{
+			settings.seed = strtoull(value, NULL, 10);
+		}
+		else if (option == "--ticks")
+		{
+			options.numberOfTicks = atoi(value);
+		}
+		else if (option == "--every")
+		{
+			options.reportEvery = atoi(value);
+		}
+		else if (option == "--timings")
+		{
+			options.timingsFileName = value;
+		}
+		else if (option == "--collision")
+		{
+			if (strcmp(value, "grid") == 0)
+			{
+				settings.bruteForce = false;
+			}
+			else if (strcmp(value, "brute-force") == 0)
+			{
+				settings.bruteForce = true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if (option == "--format")
+		{
+			if (strcmp(value, "csv") == 0)
+			{
+				options.format = FORMAT_CSV;
+			}
+			else if (strcmp(value, "json") == 0)
+			{
+				options.format = FORMAT_JSON;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		i++;
+	}
+
+	if (settings.numberOfShields < 0)
+	{
+		settings.numberOfShields = settings.fieldSize.width / 30;
+	}
+
+	if (settings.maxBombs < 0)
+	{
+		settings.maxBombs = std::min(std::max(settings.numberOfColumns * MAX_NUMBER_ALIEN_BOMBS / NUM_ALIEN_COLS, 1), int(MAX_STRESS_BOMBS));
+	}
+
+	return options.numberOfTicks > 0 && options.reportEvery > 0;
+}
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: textinvaders-stress [--width W] [--height H] [--rows N] [--cols N] [--shields N] [--gunners N]\n"
+		"                           [--bombs N] [--lines N] [--seed S] [--ticks N] [--collision grid|brute-force]\n"
+		"                           [--every N] [--format csv|json] [--timings file] [--view]\n");
+}
@@ -0,0 +1,625 @@
+#include <iostream>
+#include "Versus.h"
+#include "Rollback.h"
+#include "GameDraw.h"
+#include "Renderer.h"
+#include "CursesUtils.h"
+#include <string>
+#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// textinvaders-versus: two players, two fields side by side, over UDP on localhost.
+//
+//	textinvaders-versus --player 1		(in one terminal)
+//	textinvaders-versus --player 2		(in another)
+//
+// Each side runs both fields with rollback (see Rollback.h), so your own moves show up on the next tick
+// whatever the round trip is. Every packet carries all the local inputs the other side hasn't acknowledged,
+// so a lost packet costs nothing but time. --delay and --loss fake a slow or lossy link on one machine.
+
+using namespace std::chrono;
+
+struct VersusOptions
+{
+	int player; // 0 or 1, player 1 picks the seed and the board size
+	int port;
+	int peerPort;
+	int delayMilliseconds; // added to every packet we send, one way
+	int lossPercent; // packets we send that are dropped on purpose
+	Size boardSize; // of each field, 0 to fit the terminal
+	uint64_t seed;
+};
+
+enum PacketType
+{
+	PT_HELLO = 0, // player 1's seed and board size, answered by player 2 to start the match
+	PT_INPUTS
+};
+
+// sent as is, both sides have to be the same build
+struct VersusPacket
+{
+	char magic[4];
+	int32_t type;
+	uint64_t seed; // hello only
+	uint64_t syncHash; // the sender's hash of the confirmed state at the start of syncTick
+	int64_t sentMicroseconds; // for measuring the round trip
+	int64_t echoMicroseconds; // sentMicroseconds of the newest packet the sender has had from us
+	int32_t echoDelayMicroseconds; // how long the sender held on to that packet before sending this one
+	int32_t syncTick;
+	int32_t width; // hello only
+	int32_t height;
+	int32_t tick; // the next tick the sender is going to run
+	int32_t ackTick; // the sender has every input of ours before this
+	int32_t advantage;
+	int32_t firstInputTick;
+	int32_t numberOfInputs;
+	uint8_t inputs[ROLLBACK_WINDOW];
+};
+
+struct DelayedPacket
+{
+	int64_t sendMicroseconds;
+	VersusPacket packet;
+};
+
+// the socket, the fake delay and loss, and the round trip measurement
+struct Link
+{
+	int socket;
+	int delayMicroseconds;
+	int lossPercent;
+	Random random; // for the fake loss
+	std::deque<DelayedPacket> outgoing; // packets held back by the fake delay, in the order they go out
+	int64_t echoMicroseconds; // sentMicroseconds of the newest packet from the other side
+	int64_t echoReceivedMicroseconds; // when it arrived
+	int roundTripMicroseconds;
+};
+
+const char VERSUS_MAGIC[4] = { 'T', 'I', 'V', 'S' };
+const int HELLO_INTERVAL_MICROSECONDS = 100000;
+const int SKIP_INTERVAL_TICKS = 10; // when ahead of the other player, skip at most one tick in this many
+
+bool ParseOptions(int argc, char* argv[], VersusOptions& options);
+void PrintUsage();
+
+bool OpenLink(Link& link, const VersusOptions& options);
+void CloseLink(Link& link);
+void SendPacket(Link& link, VersusPacket& packet);
+void FlushLink(Link& link);
+bool ReceivePacket(Link& link, VersusPacket& packet);
+void InitPacket(VersusPacket& packet, PacketType type);
+
+bool WaitForOpponent(Link& link, VersusOptions& options);
+void PlayMatch(Link& link, const VersusOptions& options, RollbackSession& session);
+void SendInputs(Link& link, const RollbackSession& session);
+void ReceiveInputs(Link& link, RollbackSession& session);
+
+void DrawMatch(Renderer& screen, Renderer fields[], const RollbackSession& session, const Link& link, int stalls, int longestAdvanceMicroseconds);
+void CopyField(Renderer& screen, int xPos, const Renderer& field);
+
+int HandleInput(int& gameInput, int timeoutMilliseconds);
+int64_t Microseconds();
+
+int main(int argc, char* argv[])
+{
+	VersusOptions options;
+
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Link link;
+
+	if (!OpenLink(link, options))
+	{
+		return 1;
+	}
+
+	InitializeCurses(false);
+
+	if (options.boardSize.width == 0)
+	{
+		// two fields and a divider across, a status line under them
+		options.boardSize.width = (ScreenWidth() - 1) / 2;
+		options.boardSize.height = ScreenHeight() - 1;
+	}
+
+	if (WaitForOpponent(link, options))
+	{
+		VersusState start;
+		InitVersus(start, options.boardSize, options.seed);
+
+		RollbackSession* session = new RollbackSession; // too big for the stack
+		InitRollback(*session, start, options.player);
+
+		PlayMatch(link, options, *session);
+
+		delete session;
+	}
+
+	ShutdownCurses();
+	CloseLink(link);
+
+	return 0;
+}
+
+// player 1 says hello until player 2 answers, player 2 takes the seed and board size from the hello and answers it.
+// Either side starts on the first packet it gets from the other, so a lost answer doesn't matter either.
+bool WaitForOpponent(Link& link, VersusOptions& options)
+{
+	char message[128];
+	int length = snprintf(message, sizeof(message), "player %d, waiting for player %d on port %d (q quits)",
+		options.player + 1, 2 - options.player, options.peerPort);
+	ClearScreen();
+	DrawString(0, 0, message, std::min(length, int(sizeof(message)) - 1));
+	RefreshScreen();
+
+	int64_t nextHelloMicroseconds = 0;
+
+	while (true)
+	{
+		VersusPacket packet;
+
+		while (ReceivePacket(link, packet))
+		{
+			if (options.player == 1 && packet.type == PT_HELLO)
+			{
+				options.seed = packet.seed;
+				options.boardSize.width = packet.width;
+				options.boardSize.height = packet.height;
+
+				VersusPacket answer;
+				InitPacket(answer, PT_HELLO);
+				answer.seed = options.seed;
+				answer.width = options.boardSize.width;
+				answer.height = options.boardSize.height;
+				SendPacket(link, answer);
+				FlushLink(link);
+
+				return true;
+			}
+
+			if (options.player == 0)
+			{
+				return true;
+			}
+		}
+
+		if (options.player == 0 && Microseconds() >= nextHelloMicroseconds)
+		{
+			VersusPacket hello;
+			InitPacket(hello, PT_HELLO);
+			hello.seed = options.seed;
+			hello.width = options.boardSize.width;
+			hello.height = options.boardSize.height;
+			SendPacket(link, hello);
+
+			nextHelloMicroseconds = Microseconds() + HELLO_INTERVAL_MICROSECONDS;
+		}
+
+		FlushLink(link);
+
+		if (GetCharTimeout(10) == 'q')
+		{
+			return false;
+		}
+	}
+}
+
+void PlayMatch(Link& link, const VersusOptions& options, RollbackSession& session)
+{
+	ClearScreen(); // the renderer starts out thinking the terminal is blank
+	RefreshScreen();
+
+	Renderer screen;
+	InitRenderer(screen, ScreenWidth(), ScreenHeight());
+
+	Renderer fields[VERSUS_PLAYERS];
+	for (Renderer& field : fields)
+	{
+		InitRenderer(field, options.boardSize.width, options.boardSize.height, false); // copied into screen, never presented
+	}
+
+	const int64_t TICK_MICROSECONDS = 1000000 / FPS;
+	int64_t nextTickMicroseconds = Microseconds() + TICK_MICROSECONDS;
+
+	int gameInput = GI_NONE;
+	int ticksSinceSkip = 0;
+	int stalls = 0;
+	int longestAdvanceMicroseconds = 0;
+	bool quit = false;
+
+	while (!quit)
+	{
+		ReceiveInputs(link, session);
+		FlushLink(link);
+
+		int64_t now = Microseconds();
+
+		if (now >= nextTickMicroseconds)
+		{
+			ticksSinceSkip++;
+
+			if (TicksAhead(session) > 0 && ticksSinceSkip >= SKIP_INTERVAL_TICKS)
+			{
+				ticksSinceSkip = 0; // give the other side a tick to catch up, they see us a round trip late anyway
+			}
+			else if (!CanAdvance(session))
+			{
+				stalls++; // the keys stay in gameInput for the next tick we do run
+			}
+			else
+			{
+				int64_t advanceStart = Microseconds();
+				AdvanceRollback(session, gameInput);
+				longestAdvanceMicroseconds = std::max(longestAdvanceMicroseconds, int(Microseconds() - advanceStart));
+				gameInput = GI_NONE;
+			}
+
+			SendInputs(link, session);
+			FlushLink(link);
+
+			DrawMatch(screen, fields, session, link, stalls, longestAdvanceMicroseconds);
+
+			nextTickMicroseconds += TICK_MICROSECONDS;
+			if (Microseconds() - nextTickMicroseconds > MAX_TICKS_PER_FRAME * TICK_MICROSECONDS)
+			{
+				nextTickMicroseconds = Microseconds(); // we stalled, drop the backlog instead of fast forwarding
+			}
+		}
+
+		// wait for a key until the next tick, or the next delayed packet is due to go out
+		int64_t wakeMicroseconds = nextTickMicroseconds;
+		if (!link.outgoing.empty())
+		{
+			wakeMicroseconds = std::min(wakeMicroseconds, link.outgoing.front().sendMicroseconds);
+		}
+
+		int timeoutMilliseconds = int(std::max<int64_t>(0, (wakeMicroseconds - Microseconds() + 999) / 1000));
+
+		if (HandleInput(gameInput, timeoutMilliseconds) == 'q')
+		{
+			quit = true;
+		}
+	}
+}
+
+// every local input the other side hasn't acknowledged, every time
+void SendInputs(Link& link, const RollbackSession& session)
+{
+	VersusPacket packet;
+	InitPacket(packet, PT_INPUTS);
+
+	packet.tick = session.currentTick;
+	packet.ackTick = session.confirmedTick;
+	packet.advantage = LocalAdvantage(session);
+	packet.firstInputTick = session.remoteAckTick;
+	packet.numberOfInputs = std::min(session.currentTick - session.remoteAckTick, int(ROLLBACK_WINDOW));
+
+	for (int i = 0; i < packet.numberOfInputs; i++)
+	{
+		packet.inputs[i] = uint8_t(GetLocalInput(session, packet.firstInputTick + i));
+	}
+
+	packet.syncTick = session.syncTick;
+	packet.syncHash = session.syncTick >= 0 ? session.syncHashes[session.syncTick % ROLLBACK_WINDOW] : 0;
+
+	SendPacket(link, packet);
+}
+
+void ReceiveInputs(Link& link, RollbackSession& session)
+{
+	VersusPacket packet;
+
+	while (ReceivePacket(link, packet))
+	{
+		if (packet.type != PT_INPUTS || packet.numberOfInputs < 0 || packet.numberOfInputs > ROLLBACK_WINDOW)
+		{
+			continue; // a late hello
+		}
+
+		for (int i = 0; i < packet.numberOfInputs; i++)
+		{
+			AddRemoteInput(session, packet.firstInputTick + i, packet.inputs[i]);
+		}
+
+		AddRemoteStatus(session, packet.tick, packet.ackTick, packet.advantage);
+		CheckRemoteHash(session, packet.syncTick, packet.syncHash);
+	}
+}
+
+bool OpenLink(Link& link, const VersusOptions& options)
+{
+	link.socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	link.delayMicroseconds = options.delayMilliseconds * 1000;
+	link.lossPercent = options.lossPercent;
+	SeedRandom(link.random, uint64_t(Microseconds()));
+	link.echoMicroseconds = 0;
+	link.echoReceivedMicroseconds = 0;
+	link.roundTripMicroseconds = 0;
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	address.sin_port = htons(uint16_t(options.port));
+	bool bound = link.socket >= 0 && bind(link.socket, (sockaddr*)&address, sizeof(address)) == 0;
+
+	// connected, so only the other player's packets get through and send doesn't need an address
+	address.sin_port = htons(uint16_t(options.peerPort));
+	if (!bound || connect(link.socket, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		fprintf(stderr, "could not use UDP port %d: %s\n", options.port, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void CloseLink(Link& link)
+{
+	close(link.socket);
+}
+
+void InitPacket(VersusPacket& packet, PacketType type)
+{
+	memset(&packet, 0, sizeof(packet));
+	memcpy(packet.magic, VERSUS_MAGIC, sizeof(VERSUS_MAGIC));
+	packet.type = type;
+	packet.syncTick = NOT_IN_PLAY;
+}
+
+// queues the packet behind the fake delay, or drops it
+void SendPacket(Link& link, VersusPacket& packet)
+{
+	int64_t now = Microseconds();
+
+	// the fake delay counts as part of the trip, so the time we held on to the echo is up to now, not up to the real send
+	packet.sentMicroseconds = now;
+	packet.echoMicroseconds = link.echoMicroseconds;
+	packet.echoDelayMicroseconds = link.echoMicroseconds != 0 ? int32_t(now - link.echoReceivedMicroseconds) : 0;
+
+	if (link.lossPercent > 0 && RandomInt(link.random, 100) < link.lossPercent)
+	{
+		return;
+	}
+
+	DelayedPacket delayed;
+	delayed.sendMicroseconds = now + link.delayMicroseconds;
+	delayed.packet = packet;
+	link.outgoing.push_back(delayed);
+}
+
+// sends every queued packet whose delay is up
+void FlushLink(Link& link)
+{
+	int64_t now = Microseconds();
+
+	while (!link.outgoing.empty() && link.outgoing.front().sendMicroseconds <= now)
+	{
+		const VersusPacket& packet = link.outgoing.front().packet;
+		send(link.socket, &packet, sizeof(packet), MSG_DONTWAIT); // a full socket is just more loss
+		link.outgoing.pop_front();
+	}
+}
+
+bool ReceivePacket(Link& link, VersusPacket& packet)
+{
+	while (true)
+	{
+		ssize_t received = recv(link.socket, &packet, sizeof(packet), MSG_DONTWAIT);
+
+		if (received < 0)
+		{
+			// nothing yet, or ECONNREFUSED while the other side isn't running
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			return false;
+		}
+
+		if (received != sizeof(packet) || memcmp(packet.magic, VERSUS_MAGIC, sizeof(VERSUS_MAGIC)) != 0)
+		{
+			continue;
+		}
+
+		int64_t now = Microseconds();
+
+		if (packet.sentMicroseconds > link.echoMicroseconds)
+		{
+			link.echoMicroseconds = packet.sentMicroseconds;
+			link.echoReceivedMicroseconds = now;
+		}
+
+		if (packet.echoMicroseconds != 0)
+		{
+			link.roundTripMicroseconds = int(now - packet.echoMicroseconds - packet.echoDelayMicroseconds);
+		}
+
+		return true;
+	}
+}
+
+void DrawMatch(Renderer& screen, Renderer fields[], const RollbackSession& session, const Link& link, int stalls, int longestAdvanceMicroseconds)
+{
+	const VersusState& state = session.state;
+
+	BeginFrame(screen);
+
+	// your field on the left
+	for (int i = 0; i < VERSUS_PLAYERS; i++)
+	{
+		int player = i == 0 ? session.localPlayer : session.remotePlayer;
+		const GameWorld& world = state.worlds[player];
+
+		BeginFrame(fields[player]);
+		DrawGame(fields[player], world.game, world.player, world.shields, NUM_SHIELDS, world.aliens);
+		CopyField(screen, i * (fields[player].width + 1), fields[player]);
+	}
+
+	for (int y = 0; y < fields[0].height; y++)
+	{
+		RenderCharacter(screen, fields[0].width, y, '|');
+	}
+
+	const GameWorld& you = state.worlds[session.localPlayer];
+	const GameWorld& them = state.worlds[session.remotePlayer];
+
+	const char* result = "";
+	if (state.winner == VERSUS_DRAW)
+	{
+		result = "  DRAW";
+	}
+	else if (state.winner != NOT_IN_PLAY)
+	{
+		result = state.winner == session.localPlayer ? "  YOU WIN" : "  YOU LOSE";
+	}
+
+	char line[256];
+	int length = snprintf(line, sizeof(line),
+		"you %d (%d lives, %d incoming)  them %d (%d lives)  ping %dms  rollbacks %d (longest %d)  stalls %d  tick max %.2fms%s%s",
+		you.player.score, you.player.lives, state.pendingGarbage[session.localPlayer], them.player.score, them.player.lives,
+		link.roundTripMicroseconds / 1000, session.rollbacks, session.longestRollback, stalls, longestAdvanceMicroseconds / 1000.0,
+		session.desynced ? "  DESYNC" : "", result);
+
+	RenderString(screen, 0, fields[0].height, line, std::min(length, int(sizeof(line)) - 1));
+
+	PresentFrame(screen);
+}
+
+void CopyField(Renderer& screen, int xPos, const Renderer& field)
+{
+	for (int y = 0; y < field.height; y++)
+	{
+		RenderString(screen, xPos, y, field.backBuffer.data() + y * field.width, field.width);
+	}
+}
+
+int HandleInput(int& gameInput, int timeoutMilliseconds)
+{
+	int input = GetCharTimeout(timeoutMilliseconds);
+	switch (input)
+	{
+	case AK_LEFT:
+		gameInput |= GI_LEFT;
+		break;
+	case AK_RIGHT:
+		gameInput |= GI_RIGHT;
+		break;
+	case ' ':
+		gameInput |= GI_FIRE;
+		break;
+	}
+
+	return input;
+}
+
+int64_t Microseconds()
+{
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool ParseOptions(int argc, char* argv[], VersusOptions& options)
+{
+	options.player = NOT_IN_PLAY;
+	options.port = 0;
+	options.peerPort = 0;
+	options.delayMilliseconds = 0;
+	options.lossPercent = 0;
+	options.boardSize.width = 0;
+	options.boardSize.height = 0;
+	options.seed = uint64_t(time(NULL));
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (option == "--player")
+		{
+			options.player = atoi(value) - 1;
+		}
+		else if (option == "--port")
+		{
+			options.port = atoi(value);
+		}
+		else if (option == "--peer-port")
+		{
+			options.peerPort = atoi(value);
+		}
+		else if (option == "--delay")
+		{
+			options.delayMilliseconds = atoi(value);
+		}
+		else if (option == "--loss")
+		{
+			options.lossPercent = atoi(value);
+		}
+		else if (option == "--width")
+		{
+			options.boardSize.width = atoi(value);
+		}
+		else if (option == "--height")
+		{
+			options.boardSize.height = atoi(value);
+		}
+		else if (option == "--seed")
+		{
+			options.seed = strtoull(value, NULL, 10);
+		}
+		else
+		{
+			return false;
+		}
+
+		i++;
+	}
+
+	if (options.player != 0 && options.player != 1)
+	{
+		return false;
+	}
+
+	// player 1 on 7001, player 2 on 7002, unless told otherwise
+	if (options.port == 0)
+	{
+		options.port = 7001 + options.player;
+	}
+
+	if (options.peerPort == 0)
+	{
+		options.peerPort = 7002 - options.player;
+	}
+
+	return options.delayMilliseconds >= 0 && options.lossPercent >= 0 && options.lossPercent < 100 &&
+		(options.boardSize.width > 0) == (options.boardSize.height > 0);
+}
+
+void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: textinvaders-versus --player 1|2 [--port P] [--peer-port P] [--delay ms] [--loss percent]\n"
+		"                           [--width W] [--height H] [--seed S]\n"
+		"player 1 picks the board size and seed, --delay and --loss fake a slow link for the packets this side sends\n");
+}
@@ -0,0 +1,130 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+void WorkerLoop(ThreadPool& pool, int workerIndex);
+bool PopTask(ThreadPool& pool, int workerIndex, Task& task);
+
+void StartThreadPool(ThreadPool& pool, int numberOfThreads)
+{
+	if (numberOfThreads <= 0)
+	{
+		numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	pool.queuedTasks = 0;
+	pool.pendingTasks = 0;
+	pool.nextQueue = 0;
+	pool.stopping = false;
+
+	for (int i = 0; i < numberOfThreads; i++)
+	{
+		pool.queues.emplace_back(new WorkQueue());
+	}
+
+	for (int i = 0; i < numberOfThreads; i++)
+	{
+		pool.workers.emplace_back(WorkerLoop, std::ref(pool), i);
+	}
+}
+
+void StopThreadPool(ThreadPool& pool)
+{
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.stopping = true;
+	}
+
+	pool.workAvailable.notify_all();
+
+	for (std::thread& worker : pool.workers)
+	{
+		worker.join();
+	}
+
+	pool.workers.clear();
+	pool.queues.clear();
+}
+
+void SubmitTask(ThreadPool& pool, Task task)
+{
+	pool.pendingTasks++;
+
+	WorkQueue& queue = *pool.queues[pool.nextQueue++ % pool.queues.size()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.queuedTasks++;
+	}
+
+	pool.workAvailable.notify_one();
+}
+
+void WaitForTasks(ThreadPool& pool)
+{
+	std::unique_lock<std::mutex> lock(pool.mutex);
+	pool.workDone.wait(lock, [&pool] { return pool.pendingTasks == 0; });
+}
+
+void WorkerLoop(ThreadPool& pool, int workerIndex)
+{
+	for (;;)
+	{
+		Task task;
+
+		if (PopTask(pool, workerIndex, task))
+		{
+			task();
+
+			if (--pool.pendingTasks == 0)
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex);
+				pool.workDone.notify_all();
+			}
+
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(pool.mutex);
+		pool.workAvailable.wait(lock, [&pool] { return pool.stopping || pool.queuedTasks > 0; });
+
+		if (pool.stopping && pool.queuedTasks <= 0)
+		{
+			return;
+		}
+	}
+}
+
+// our own queue first (newest task, it's the most likely to be warm in cache), then steal the oldest task from the others
+bool PopTask(ThreadPool& pool, int workerIndex, Task& task)
+{
+	int numberOfQueues = int(pool.queues.size());
+
+	for (int i = 0; i < numberOfQueues; i++)
+	{
+		WorkQueue& queue = *pool.queues[(workerIndex + i) % numberOfQueues];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.tasks.empty())
+		{
+			if (i == 0)
+			{
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+			}
+
+			pool.queuedTasks--;
+			return true;
+		}
+	}
+
+	return false;
+}
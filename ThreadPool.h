@@ -0,0 +1,38 @@
+#pragma once
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+typedef std::function<void()> Task;
+
+struct WorkQueue
+{
+	std::mutex mutex;
+	std::deque<Task> tasks;
+};
+
+// Work stealing thread pool. Every worker has its own queue and takes tasks from the back of it,
+// when that runs dry it steals from the front of the other workers' queues.
+struct ThreadPool
+{
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	std::mutex mutex; // guards sleeping, waking and waiting
+	std::condition_variable workAvailable;
+	std::condition_variable workDone;
+	std::atomic<int> queuedTasks; // submitted but not picked up yet
+	std::atomic<int> pendingTasks; // submitted but not finished yet
+	std::atomic<unsigned> nextQueue;
+	bool stopping;
+};
+
+void StartThreadPool(ThreadPool& pool, int numberOfThreads = 0); // 0 uses every core
+void StopThreadPool(ThreadPool& pool);
+
+void SubmitTask(ThreadPool& pool, Task task);
+void WaitForTasks(ThreadPool& pool);
@@ -0,0 +1,198 @@
+#pragma once
+
+// Hierarchical timer wheel for events a whole number of ticks away, in a fixed block with no pointers so it can live
+// in a GameWorld. Level 0 has a slot for each of the next TIMER_WHEEL_SLOTS ticks and level 1 a slot for each run of
+// TIMER_WHEEL_SLOTS ticks after that; when the clock reaches the start of a run, that run's level 1 slot is spread
+// over level 0. Each slot is a list threaded through index arrays, so scheduling is O(1) and a tick only touches
+// the timers due on it, however many are waiting.
+
+enum
+{
+	TIMER_WHEEL_BITS = 5,
+	TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_BITS,
+	TIMER_WHEEL_LEVELS = 2,
+	NO_TIMER = -1
+};
+
+struct TimerEvent
+{
+	int type; // what to do, up to the owner
+	int data;
+};
+
+template<int CAPACITY>
+struct TimerWheel
+{
+	int now; // the tick AdvanceTimers last moved to
+	int count; // timers scheduled and not handed out yet
+	int firstFree;
+	int firstDue; // timers due at now that NextDueTimer hasn't handed out yet
+	int slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; // first timer in each slot
+	int next[CAPACITY]; // next timer in the same slot, or in the free list
+	int dueTick[CAPACITY];
+	TimerEvent events[CAPACITY];
+};
+
+template<int CAPACITY>
+void InitTimerWheel(TimerWheel<CAPACITY>& wheel)
+{
+	wheel.now = 0;
+	wheel.count = 0;
+	wheel.firstFree = 0;
+	wheel.firstDue = NO_TIMER;
+
+	for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+		{
+			wheel.slots[level][slot] = NO_TIMER;
+		}
+	}
+
+	for (int i = 0; i < CAPACITY; i++)
+	{
+		wheel.next[i] = i + 1 < CAPACITY ? i + 1 : NO_TIMER;
+		wheel.dueTick[i] = 0;
+		wheel.events[i].type = 0;
+		wheel.events[i].data = 0;
+	}
+}
+
+// files the timer in the slot that comes round on its tick
+template<int CAPACITY>
+void InsertTimer(TimerWheel<CAPACITY>& wheel, int timer)
+{
+	const int MASK = TIMER_WHEEL_SLOTS - 1;
+	int due = wheel.dueTick[timer];
+	int delay = due - wheel.now;
+	int* slot;
+
+	if (delay < TIMER_WHEEL_SLOTS)
+	{
+		slot = &wheel.slots[0][due & MASK];
+	}
+	else if (delay < TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS)
+	{
+		slot = &wheel.slots[1][(due >> TIMER_WHEEL_BITS) & MASK];
+	}
+	else
+	{
+		// further than level 1 reaches, park it in the slot that comes round last and file it again from there
+		slot = &wheel.slots[1][(wheel.now >> TIMER_WHEEL_BITS) & MASK];
+	}
+
+	wheel.next[timer] = *slot;
+	*slot = timer;
+}
+
+// delay is in ticks from now, anything under 1 is taken as 1, false if every timer is in use
+template<int CAPACITY>
+bool ScheduleTimer(TimerWheel<CAPACITY>& wheel, int delay, int type, int data)
+{
+	int timer = wheel.firstFree;
+
+	if (timer == NO_TIMER)
+	{
+		return false;
+	}
+
+	wheel.firstFree = wheel.next[timer];
+	wheel.dueTick[timer] = wheel.now + (delay > 1 ? delay : 1);
+	wheel.events[timer].type = type;
+	wheel.events[timer].data = data;
+	wheel.count++;
+
+	InsertTimer(wheel, timer);
+
+	return true;
+}
+
+// moves the clock on a tick, the timers due then come out of NextDueTimer,
+// which has to be called until it returns false before the clock moves again
+template<int CAPACITY>
+void AdvanceTimers(TimerWheel<CAPACITY>& wheel)
+{
+	const int MASK = TIMER_WHEEL_SLOTS - 1;
+
+	wheel.now++;
+
+	if ((wheel.now & MASK) == 0)
+	{
+		int* run = &wheel.slots[1][(wheel.now >> TIMER_WHEEL_BITS) & MASK];
+		int timer = *run;
+		*run = NO_TIMER;
+
+		while (timer != NO_TIMER)
+		{
+			int next = wheel.next[timer];
+			InsertTimer(wheel, timer);
+			timer = next;
+		}
+	}
+
+	int* slot = &wheel.slots[0][wheel.now & MASK];
+	wheel.firstDue = *slot;
+	*slot = NO_TIMER;
+}
+
+// false once every timer due at now has been handed out
+template<int CAPACITY>
+bool NextDueTimer(TimerWheel<CAPACITY>& wheel, TimerEvent& event)
+{
+	int timer = wheel.firstDue;
+
+	if (timer == NO_TIMER)
+	{
+		return false;
+	}
+
+	wheel.firstDue = wheel.next[timer];
+	event = wheel.events[timer];
+
+	wheel.next[timer] = wheel.firstFree;
+	wheel.firstFree = timer;
+	wheel.count--;
+
+	return true;
+}
+
+// for a wheel read from outside: every link is in range and every timer is on exactly one list, the free list,
+// the ones due now or a slot's, so walking them always ends
+template<int CAPACITY>
+bool IsTimerWheelValid(const TimerWheel<CAPACITY>& wheel)
+{
+	bool seen[CAPACITY] = {};
+	int numberOfTimers = 0;
+	int numberOfFree = 0;
+
+	const int* lists[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS + 2];
+	int numberOfLists = 0;
+
+	lists[numberOfLists++] = &wheel.firstFree;
+	lists[numberOfLists++] = &wheel.firstDue;
+
+	for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+		{
+			lists[numberOfLists++] = &wheel.slots[level][slot];
+		}
+	}
+
+	for (int list = 0; list < numberOfLists; list++)
+	{
+		for (int timer = *lists[list]; timer != NO_TIMER; timer = wheel.next[timer])
+		{
+			if (timer < 0 || timer >= CAPACITY || seen[timer])
+			{
+				return false;
+			}
+
+			seen[timer] = true;
+			numberOfTimers++;
+			numberOfFree += list == 0 ? 1 : 0;
+		}
+	}
+
+	return numberOfTimers == CAPACITY && wheel.count == CAPACITY - numberOfFree;
+}
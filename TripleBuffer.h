@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+
+// Hands the latest copy of something from one writer thread to one reader thread without either ever waiting.
+// The writer fills the back buffer and publishes it, the reader takes whatever was published last.
+// Three buffers means the writer always has one to fill and the reader always has a complete one to read,
+// if the writer publishes faster than the reader reads, the reader just skips the ones in between.
+template<typename T>
+struct TripleBuffer
+{
+	T buffers[3];
+	std::atomic<int> middle; // the buffer passed between the two, with TRIPLE_BUFFER_NEW set until the reader takes it
+	int back; // only touched by the writer
+	int front; // only touched by the reader
+};
+
+const int TRIPLE_BUFFER_INDEX = 3;
+const int TRIPLE_BUFFER_NEW = 4;
+
+template<typename T>
+void InitTripleBuffer(TripleBuffer<T>& buffer)
+{
+	buffer.back = 0;
+	buffer.middle.store(1, std::memory_order_relaxed);
+	buffer.front = 2;
+}
+
+template<typename T>
+T& WriteBuffer(TripleBuffer<T>& buffer)
+{
+	return buffer.buffers[buffer.back];
+}
+
+// makes the write buffer the latest, the writer gets a different one to fill next
+template<typename T>
+void PublishWriteBuffer(TripleBuffer<T>& buffer)
+{
+	buffer.back = buffer.middle.exchange(buffer.back | TRIPLE_BUFFER_NEW, std::memory_order_acq_rel) & TRIPLE_BUFFER_INDEX;
+}
+
+// moves the reader on to the latest published buffer, returns false if nothing new has been published since last time
+template<typename T>
+bool ReadLatest(TripleBuffer<T>& buffer)
+{
+	if ((buffer.middle.load(std::memory_order_relaxed) & TRIPLE_BUFFER_NEW) == 0)
+	{
+		return false;
+	}
+
+	buffer.front = buffer.middle.exchange(buffer.front, std::memory_order_acq_rel) & TRIPLE_BUFFER_INDEX;
+	return true;
+}
+
+template<typename T>
+const T& ReadBuffer(const TripleBuffer<T>& buffer)
+{
+	return buffer.buffers[buffer.front];
+}
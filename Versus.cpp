@@ -0,0 +1,139 @@
+#include "Versus.h"
+#include <algorithm>
+
+bool DropGarbage(GameWorld& world);
+
+void InitVersus(VersusState& state, const Size& boardSize, uint64_t seed)
+{
+	// both fields start from the same seed, so neither player gets an easier swarm
+	for (int player = 0; player < VERSUS_PLAYERS; player++)
+	{
+		InitGameWorld(state.worlds[player], boardSize, seed);
+		state.kills[player] = 0;
+		state.pendingGarbage[player] = 0;
+	}
+
+	state.tick = 0;
+	state.winner = NOT_IN_PLAY;
+}
+
+void StepVersus(VersusState& state, const int inputs[VERSUS_PLAYERS])
+{
+	if (state.winner != NOT_IN_PLAY)
+	{
+		return;
+	}
+
+	bool cleared[VERSUS_PLAYERS];
+	bool lost[VERSUS_PLAYERS];
+
+	for (int player = 0; player < VERSUS_PLAYERS; player++)
+	{
+		GameWorld& world = state.worlds[player];
+		int aliensBefore = world.aliens.numAliensLeft;
+		int hitsBefore = world.game.stats.playerHits;
+
+		StepGameWorld(world, inputs[player]);
+
+		// the field stops until the player presses fire, which takes a life and ends the game on the last one
+		if (world.game.stats.playerHits != hitsBefore && world.game.currentState == GS_PLAY)
+		{
+			world.game.currentState = GS_PLAYER_DEAD;
+		}
+
+		int opponent = (player + 1) % VERSUS_PLAYERS;
+		state.kills[player] += aliensBefore - world.aliens.numAliensLeft;
+
+		while (state.kills[player] >= KILLS_PER_GARBAGE_ALIEN)
+		{
+			state.kills[player] -= KILLS_PER_GARBAGE_ALIEN;
+			state.pendingGarbage[opponent] = std::min(state.pendingGarbage[opponent] + 1, int(MAX_PENDING_GARBAGE));
+		}
+
+		cleared[player] = world.aliens.numAliensLeft == 0;
+		lost[player] = world.game.currentState == GS_GAME_OVER;
+	}
+
+	// garbage lands one alien a tick, so it trickles in instead of reappearing as a block
+	for (int player = 0; player < VERSUS_PLAYERS; player++)
+	{
+		if (state.pendingGarbage[player] > 0 && !cleared[player] && DropGarbage(state.worlds[player]))
+		{
+			state.pendingGarbage[player]--;
+		}
+	}
+
+	state.tick++;
+
+	bool won[VERSUS_PLAYERS];
+	int numberOfWinners = 0;
+
+	for (int player = 0; player < VERSUS_PLAYERS; player++)
+	{
+		won[player] = cleared[player] || lost[(player + 1) % VERSUS_PLAYERS];
+		numberOfWinners += won[player] ? 1 : 0;
+	}
+
+	if (numberOfWinners > 1)
+	{
+		state.winner = VERSUS_DRAW;
+	}
+	else if (numberOfWinners == 1)
+	{
+		state.winner = won[0] ? 0 : 1;
+	}
+}
+
+// brings back one dead alien inside the swarm's current bounds, so it can't appear off the edge of the field
+// or below the shields. The slot comes from the field's own random numbers, which keeps the game deterministic.
+bool DropGarbage(GameWorld& world)
+{
+	AlienSwarm& aliens = world.aliens;
+
+	if (world.game.currentState != GS_PLAY || aliens.occupiedColumns == 0)
+	{
+		return false;
+	}
+
+	int firstColumn = LowestSetBit(aliens.occupiedColumns);
+	int lastColumn = HighestSetBit(aliens.occupiedColumns);
+	int lastRow = HighestSetBit(aliens.occupiedRows);
+
+	int deadSlots[NUM_ALIEN_ROWS * NUM_ALIEN_COLS];
+	int numberOfDeadSlots = 0;
+
+	for (int row = 0; row <= lastRow; row++)
+	{
+		Bitmask dead = BitRange(firstColumn, lastColumn - firstColumn + 1) & ~(aliens.aliveInRow[row] | aliens.explodingInRow[row]);
+
+		for (; dead != 0; dead &= dead - 1)
+		{
+			deadSlots[numberOfDeadSlots++] = row * NUM_ALIEN_COLS + LowestSetBit(dead);
+		}
+	}
+
+	if (numberOfDeadSlots == 0)
+	{
+		return false;
+	}
+
+	int slot = deadSlots[RandomInt(world.game.random, numberOfDeadSlots)];
+	return ReviveAlien(aliens, slot / NUM_ALIEN_COLS, slot % NUM_ALIEN_COLS);
+}
+
+uint64_t HashVersus(const VersusState& state)
+{
+	uint64_t hash = HashGameWorld(state.worlds[0]);
+
+	for (int player = 1; player < VERSUS_PLAYERS; player++)
+	{
+		hash = hash * 0x9e3779b97f4a7c15ULL ^ HashGameWorld(state.worlds[player]);
+	}
+
+	for (int player = 0; player < VERSUS_PLAYERS; player++)
+	{
+		hash = hash * 0x9e3779b97f4a7c15ULL ^ (uint64_t(state.kills[player]) << 32 | uint32_t(state.pendingGarbage[player]));
+	}
+
+	return hash * 0x9e3779b97f4a7c15ULL ^ (uint64_t(state.tick) << 32 | uint32_t(state.winner));
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "GameWorld.h"
+
+// Two player versus: each player has their own field, stepped with their own input, and every
+// KILLS_PER_GARBAGE_ALIEN aliens a player shoots bring one dead alien back to life in the other player's swarm.
+// Clearing your swarm wins, losing your last life loses: unlike the one player game, where a bomb only counts
+// as a hit, here it kills the player, who presses fire to carry on with the next life. Like a GameWorld,
+// a VersusState is one flat block, so the rollback code can snapshot, restore and hash it with plain copies.
+
+enum
+{
+	VERSUS_PLAYERS = 2,
+	KILLS_PER_GARBAGE_ALIEN = 2,
+	MAX_PENDING_GARBAGE = 16, // garbage that can't land yet waits, up to this many
+	VERSUS_DRAW = VERSUS_PLAYERS // winner when both players finish on the same tick
+};
+
+struct VersusState
+{
+	GameWorld worlds[VERSUS_PLAYERS];
+	int kills[VERSUS_PLAYERS]; // kills towards the next garbage alien each player sends
+	int pendingGarbage[VERSUS_PLAYERS]; // garbage aliens waiting to land in each player's swarm
+	int tick;
+	int winner; // NOT_IN_PLAY while the match is on, a player or VERSUS_DRAW after
+};
+
+static_assert(std::is_trivially_copyable<VersusState>::value &&
+	sizeof(VersusState) == VERSUS_PLAYERS * (sizeof(GameWorld) + 2 * sizeof(int)) + 2 * sizeof(int) &&
+	sizeof(VersusState) % sizeof(uint64_t) == 0, "a VersusState has to be a flat block with no padding, like a GameWorld");
+
+void InitVersus(VersusState& state, const Size& boardSize, uint64_t seed);
+void StepVersus(VersusState& state, const int inputs[VERSUS_PLAYERS]); // inputs are GameInput flags for each player
+uint64_t HashVersus(const VersusState& state);